@@ -0,0 +1,58 @@
+# packs every file under RESOURCES_DIR into a single page aligned array that is compiled into the
+# binary, along with an index sorted by path. run in script mode:
+#   cmake -DRESOURCES_DIR=<dir> -DOUTPUT=<file.cpp> -P pack_resources.cmake
+
+file(GLOB_RECURSE resources RELATIVE "${RESOURCES_DIR}" "${RESOURCES_DIR}/*")
+list(SORT resources)
+
+set(data "")
+set(index "")
+set(offset 0)
+
+foreach(resource IN LISTS resources)
+    file(READ "${RESOURCES_DIR}/${resource}" hex HEX)
+    string(LENGTH "${hex}" length)
+    math(EXPR size "${length} / 2")
+
+    # every entry starts on a 16 byte boundary
+    math(EXPR padding "(16 - ${size} % 16) % 16")
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," bytes "${hex}")
+    if (padding GREATER 0)
+        string(REPEAT "0x00," ${padding} zeroes)
+        string(APPEND bytes "${zeroes}")
+    endif()
+
+    string(APPEND data "    // ${resource}\n    ${bytes}\n")
+    string(APPEND index "    { \"${resource}\", ${offset}, ${size} },\n")
+
+    math(EXPR offset "${offset} + ${size} + ${padding}")
+endforeach()
+
+if (offset EQUAL 0)
+    set(data "    0x00,\n")
+endif()
+
+file(WRITE "${OUTPUT}.tmp"
+"// generated by cmake/pack_resources.cmake, do not edit
+#include \"Resources.hpp\"
+
+alignas(4096) static constexpr unsigned char PACKED_DATA[] {
+${data}};
+
+static constexpr PackedResource PACKED_INDEX[] {
+${index}    { nullptr, 0, 0 },
+};
+
+std::span<unsigned char const> get_packed_data()
+{
+    return PACKED_DATA;
+}
+
+std::span<PackedResource const> get_packed_index()
+{
+    return std::span(PACKED_INDEX).first(std::size(PACKED_INDEX) - 1);
+}
+")
+
+file(COPY_FILE "${OUTPUT}.tmp" "${OUTPUT}" ONLY_IF_DIFFERENT)
+file(REMOVE "${OUTPUT}.tmp")
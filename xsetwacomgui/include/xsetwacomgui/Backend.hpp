@@ -0,0 +1,102 @@
+#pragma once
+
+#include "Input.hpp"
+#include "Monitor.hpp"
+#include "Settings.hpp"
+
+#include <libwacom/Device.hpp>
+#include <liberror/Result.hpp>
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct Backend
+{
+    using DeviceId = decltype(libwacom::Device::id);
+
+    std::function<liberror::Result<std::vector<Monitor>>()> get_available_monitors;
+    std::function<liberror::Result<std::vector<libwacom::Device>>()> get_available_devices;
+    std::function<liberror::Result<ProductId>(std::string_view)> get_device_product_id;
+    std::function<liberror::Result<std::vector<DeviceLocation>>()> get_device_locations;
+    std::function<liberror::Result<std::vector<DeviceProperties>>()> get_device_properties;
+    std::function<liberror::Result<libwacom::Area>(DeviceId)> get_stylus_default_area;
+    std::function<liberror::Result<libwacom::Area>(DeviceId)> get_stylus_area;
+    std::function<liberror::Result<libwacom::Pressure>(DeviceId)> get_stylus_pressure_curve;
+    std::function<liberror::Result<void>(DeviceId, libwacom::Area)> set_stylus_area;
+    std::function<liberror::Result<void>(DeviceId, libwacom::Pressure)> set_stylus_pressure_curve;
+    std::function<liberror::Result<void>(DeviceId, libwacom::Area)> set_stylus_output_from_display_area;
+    std::function<liberror::Result<std::unique_ptr<StylusInput>>(std::string_view)> open_stylus_input;
+    std::function<liberror::Result<std::unique_ptr<DevicePropertyWatcher>>(std::string_view)> watch_device_properties;
+};
+
+// talks to the X server through xrandr and the wacom driver
+Backend make_system_backend();
+// deterministic devices and monitors that never leave the process, used for benchmarking
+Backend make_fake_backend();
+
+inline Backend& the_backend()
+{
+    static Backend backend = make_system_backend();
+    return backend;
+}
+
+inline void set_backend(Backend value)
+{
+    auto& backend = the_backend();
+    backend = std::move(value);
+}
+
+// reading the default area makes the driver reset the area of the device, so that read holds this lock
+// on its own while the applies share it, or it could undo an area that was just applied
+inline std::shared_mutex& the_driver_mutex()
+{
+    static std::shared_mutex mutex {};
+    return mutex;
+}
+
+// the default area of the stylus, with whatever area it had put back once the driver reported it
+liberror::Result<libwacom::Area> read_stylus_default_area(libwacom::Device const& device);
+
+// the devices the driver creates for one physical tablet, the stylus first
+struct Tablet
+{
+    std::string name;
+    std::string location;
+    std::vector<libwacom::Device> devices;
+};
+
+// the driver names every device after its tablet, as in "Wacom Intuos S Pen stylus" and "Wacom Intuos S Finger touch".
+// two tablets of the same model share those names, so they are told apart by where they are plugged in.
+std::vector<Tablet> group_devices_by_tablet(std::vector<libwacom::Device> const& devices);
+// a tablet holding only the device when it is not part of any of them
+Tablet find_tablet(std::vector<Tablet> const& tablets, libwacom::Device const& device);
+
+// what ends up written to the driver for a device, with the monitor area made absolute. whatever is
+// left empty does not apply to that kind of device and is never written.
+struct DeviceState
+{
+    std::optional<libwacom::Area> area;
+    std::optional<libwacom::Pressure> pressure;
+    std::optional<libwacom::Area> output;
+};
+
+// the state of the stylus
+DeviceState get_device_state(Monitor const& monitor, DeviceSettings const& settings);
+// one state per device of the tablet: the eraser takes everything, a puck has no pressure, the touch
+// surface only follows the output mapping and the pad takes nothing, unless the settings override it
+std::vector<DeviceState> get_tablet_state(Tablet const& tablet, Monitor const& monitor, DeviceSettings const& settings);
+
+// only writes what differs from the previous state, or everything when there is none
+liberror::Result<void> apply_device_state(libwacom::Device const& device, DeviceState const& state, std::optional<DeviceState> const& previous = std::nullopt);
+// the same through the given backend instead of the one in use, which is left alone
+liberror::Result<void> apply_device_state(Backend const& backend, libwacom::Device const& device, DeviceState const& state, std::optional<DeviceState> const& previous = std::nullopt);
+// every device of the tablet is written at the same time, as each write waits on the driver
+liberror::Result<void> apply_tablet_state(Tablet const& tablet, std::span<DeviceState const> states, std::span<DeviceState const> previous = {});
+
+liberror::Result<void> set_settings_to_tablet(Tablet const& tablet, Monitor const& monitor, DeviceSettings const& settings);
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// the files written by this program are plain sequences of native values, they are not meant to be moved
+// between machines
+class BinaryWriter
+{
+public:
+    std::string buffer;
+
+    template <class T> requires std::is_trivially_copyable_v<T>
+    void write(T const& value)
+    {
+        buffer.append(reinterpret_cast<char const*>(&value), sizeof(T));
+    }
+
+    void write(std::string const& value)
+    {
+        write(static_cast<uint32_t>(value.size()));
+        buffer.append(value);
+    }
+};
+
+// reads past the end only set the failed flag, so a whole record can be read before checking it once
+class BinaryReader
+{
+private:
+    std::string_view data;
+    size_t offset = 0;
+    bool failed_ = false;
+
+public:
+    explicit BinaryReader(std::string_view input) : data(input) {}
+
+    template <class T> requires std::is_trivially_copyable_v<T>
+    void read(T& value)
+    {
+        if (failed_ || offset + sizeof(T) > data.size()) { failed_ = true; return; }
+        std::memcpy(&value, data.data() + offset, sizeof(T));
+        offset += sizeof(T);
+    }
+
+    void read(std::string& value)
+    {
+        uint32_t size = 0;
+        read(size);
+        if (failed_ || offset + size > data.size()) { failed_ = true; return; }
+        value.assign(data.substr(offset, size));
+        offset += size;
+    }
+
+    bool failed() const { return failed_; }
+};
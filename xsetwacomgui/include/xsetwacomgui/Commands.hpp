@@ -0,0 +1,13 @@
+#pragma once
+
+#include <liberror/Result.hpp>
+
+#include <string_view>
+#include <vector>
+
+// subcommands for scripts. they run before the window, imgui or the fonts are set up and only make
+// the backend calls their operation needs.
+bool is_command(std::vector<std::string_view> const& arguments);
+liberror::Result<void> run_command(std::vector<std::string_view> const& arguments);
+
+void print_commands_help();
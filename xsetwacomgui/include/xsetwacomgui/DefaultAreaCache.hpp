@@ -0,0 +1,57 @@
+#pragma once
+
+#include <libwacom/Device.hpp>
+#include <liberror/Result.hpp>
+
+#include <atomic>
+#include <filesystem>
+#include <future>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+// the default area is a property of the tablet model and reading it may make the driver reset the
+// device, so it is kept on disk across runs and only checked against the driver in the background
+class DefaultAreaCache
+{
+private:
+    std::filesystem::path path;
+    std::mutex mutex;
+    std::map<std::string, libwacom::Area> areas;
+    std::map<std::string, std::string> keys;
+    std::set<std::string> validated; // device names
+    std::map<std::string, std::string> failures; // device names to why their area could not be read
+    std::vector<std::future<void>> validations;
+    std::atomic<size_t> changes = 0;
+
+    std::optional<std::string> find_key(std::string const& deviceName) const;
+    std::string get_key(libwacom::Device const& device);
+    void validate(libwacom::Device device);
+    void save();
+
+public:
+    DefaultAreaCache() = default;
+    ~DefaultAreaCache();
+
+    DefaultAreaCache(DefaultAreaCache const&) = delete;
+    DefaultAreaCache& operator=(DefaultAreaCache const&) = delete;
+
+    // until a file is loaded the cache only lives in memory
+    void load(std::filesystem::path const& file);
+
+    // never waits on the driver: a cached area is returned right away and checked on a worker, a tablet
+    // that was never seen before has nothing until the worker read it. a read that failed is the error.
+    liberror::Result<std::optional<libwacom::Area>> get(libwacom::Device const& device);
+
+    // bumped whenever a worker finds that a cached area was wrong or missing, or fails to read one
+    size_t generation() const { return changes.load(std::memory_order_acquire); }
+};
+
+inline DefaultAreaCache& the_default_area_cache()
+{
+    static DefaultAreaCache cache {};
+    return cache;
+}
@@ -6,4 +6,5 @@
 std::filesystem::path get_system_home_path();
 std::filesystem::path get_application_config_path();
 std::filesystem::path get_application_data_path();
+std::filesystem::path get_application_cache_path();
 
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Monitor.hpp"
+#include "Settings.hpp"
+
+#include <liberror/Result.hpp>
+
+#include <string>
+#include <vector>
+
+// an InputClass section for xorg.conf.d, which makes the X server apply the settings by itself whenever
+// the tablet is added. the output mapping becomes a TransformationMatrix over the whole screen.
+std::string export_xorg_snippet(DeviceSettings const& settings, Monitor const& monitor, std::vector<Monitor> const& monitors);
+
+// the same settings as plain xsetwacom calls
+std::string export_xsetwacom_script(DeviceSettings const& settings, Monitor const& monitor);
+
+// parses both exports back and compares them against what apply_device_state hands over to the
+// backend, the comparison is printed and any mismatch is returned as an error. the snippet is also
+// refused when it holds an option the wacom driver would not take, as the X server ignores those silently.
+liberror::Result<void> check_exports(DeviceSettings const& settings, Monitor const& monitor, std::vector<Monitor> const& monitors);
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Memory.hpp"
+
+#include <imgui/imgui.hpp>
+
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+
+// rasterises the font into a fresh atlas. "default" stands for the font built into imgui.
+std::unique_ptr<ImFontAtlas> build_font_atlas(std::string const& font, float scale);
+
+// the pixels only count until they have been uploaded and cleared, the gpu side assumes a rgba texture
+MemoryUsage get_font_atlas_memory_usage(ImFontAtlas const& atlas);
+
+// builds atlases on a worker thread so that changing the font or the scale never stalls a frame. only
+// the latest request matters, anything requested while a build is running replaces what comes next.
+class FontAtlasBuilder
+{
+private:
+    struct Request
+    {
+        std::string font;
+        float scale;
+    };
+
+    std::future<std::unique_ptr<ImFontAtlas>> pending;
+    std::optional<Request> queued;
+
+    void start(Request request);
+
+public:
+    void request(std::string font, float scale);
+
+    // hands over the latest atlas once it is built, without ever waiting for it
+    std::unique_ptr<ImFontAtlas> take();
+};
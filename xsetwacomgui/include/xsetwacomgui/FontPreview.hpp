@@ -0,0 +1,95 @@
+#pragma once
+
+#include <imgui/imgui.hpp>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// a line of text written in some font, white with the coverage in the alpha so that it can be tinted
+struct FontPreviewImage
+{
+    int width, height;
+    std::vector<uint32_t> pixels;
+};
+
+// rasterises only the glyphs the text needs into a throwaway atlas and lays the line out from it. "default"
+// stands for the font built into imgui.
+std::optional<FontPreviewImage> rasterise_font_preview(std::filesystem::path const& font, std::string const& text, float size);
+
+struct FontPreview
+{
+    ImTextureID texture;
+    ImVec2 size;
+};
+
+// previews for the rows of a font list that are on screen. they are rasterised on a worker thread, uploaded
+// a few per frame and kept as textures until the budget runs out, the least recently drawn going first.
+class FontPreviewCache
+{
+private:
+    static constexpr size_t MAX_QUEUED = 64;
+    static constexpr size_t MAX_UPLOADS_PER_FRAME = 4;
+
+    struct Request
+    {
+        std::filesystem::path font;
+        std::string text;
+    };
+
+    struct Rasterised
+    {
+        std::filesystem::path font;
+        std::optional<FontPreviewImage> image;
+    };
+
+    struct Entry
+    {
+        std::string font;
+        FontPreview preview;
+        size_t bytes;
+    };
+
+    size_t budget;
+    size_t used = 0;
+    float size;
+
+    // only touched by the render thread
+    std::list<Entry> entries {}; // most recently drawn first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index {};
+    std::unordered_set<std::string> pending {};
+    std::unordered_set<std::string> failed {};
+
+    // shared with the worker
+    std::mutex mutex;
+    std::condition_variable_any wake;
+    std::deque<Request> queue {};
+    std::vector<Rasterised> rasterised {};
+
+    std::jthread thread;
+
+    void run(std::stop_token const& token);
+    void evict();
+
+public:
+    FontPreviewCache(size_t budget, float size);
+    ~FontPreviewCache();
+
+    FontPreviewCache(FontPreviewCache const&) = delete;
+    FontPreviewCache& operator=(FontPreviewCache const&) = delete;
+
+    // never waits, a preview that isn't ready yet is queued and nullopt is returned in the meantime
+    std::optional<FontPreview> get(std::filesystem::path const& font, std::string const& text);
+
+    // moves what the worker has finished over to the gpu
+    void upload();
+};
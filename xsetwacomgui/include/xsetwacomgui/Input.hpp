@@ -0,0 +1,139 @@
+#pragma once
+
+#include "RingBuffer.hpp"
+
+#include <liberror/Result.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+struct StylusEvent
+{
+    std::chrono::steady_clock::time_point time;
+    unsigned long serverTime;
+    float x, y;         // [0, 1] over the whole device
+    float pressure;     // [0, 1]
+    float tiltX, tiltY; // [-1, 1]
+};
+
+struct StylusConnection;
+
+// reads the raw XInput2 stream of a single device on its own thread and hands the events over
+// through a lock-free queue, so whoever consumes them never waits on the X server.
+class StylusInput
+{
+private:
+    RingBuffer<StylusEvent, 8192> events;
+    std::atomic<size_t> droppedEvents = 0;
+    std::jthread thread;
+
+    StylusInput() = default;
+    void run(std::stop_token const& token, StylusConnection& connection);
+
+public:
+    static liberror::Result<std::unique_ptr<StylusInput>> open(std::string_view deviceName);
+
+    bool pop(StylusEvent& event) { return events.pop(event); }
+    size_t dropped() const { return droppedEvents.load(std::memory_order_relaxed); }
+};
+
+// tells which of the properties the wacom driver keeps for a device were changed since it was last
+// asked, whoever changed them. the values themselves are left to the backend to read.
+class DevicePropertyWatcher
+{
+public:
+    enum Property : uint32_t
+    {
+        AREA           = 1 << 0,
+        PRESSURE_CURVE = 1 << 1,
+    };
+
+private:
+    std::atomic<uint32_t> changed = 0;
+    std::jthread thread;
+
+    DevicePropertyWatcher() = default;
+    void run(std::stop_token const& token, StylusConnection& connection);
+
+public:
+    static liberror::Result<std::unique_ptr<DevicePropertyWatcher>> open(std::string_view deviceName);
+
+    uint32_t take() { return changed.exchange(0, std::memory_order_acquire); }
+};
+
+struct InputCapture
+{
+    struct RawEvent
+    {
+        std::chrono::steady_clock::time_point time;
+        unsigned long serverTime;
+        double x, y; // device units
+    };
+
+    struct CookedEvent
+    {
+        std::chrono::steady_clock::time_point time;
+        unsigned long serverTime;
+        double rootX, rootY; // screen pixels
+    };
+
+    // serverTime on the server clock was read at time on ours, give or take half the round trip
+    struct ServerClock
+    {
+        std::chrono::steady_clock::time_point time;
+        unsigned long serverTime;
+        std::chrono::steady_clock::duration roundTrip;
+    };
+
+    std::string deviceName;
+    std::chrono::nanoseconds duration;
+    ServerClock clock;
+    std::vector<RawEvent> raw;
+    std::vector<CookedEvent> cooked;
+};
+
+// records the raw and the cooked XInput2 stream of a device side by side for the given duration. the pointer
+// is grabbed meanwhile, so the device does not reach other applications until it returns
+liberror::Result<InputCapture> capture_input(std::string_view deviceName, std::chrono::nanoseconds duration);
+
+struct ProductId
+{
+    unsigned vendor, product;
+};
+
+// the usb vendor and product id that the driver reports for the device
+liberror::Result<ProductId> get_device_product_id(std::string_view deviceName);
+
+// where a device is plugged in, which is the same for every device the driver creates for one tablet
+struct DeviceLocation
+{
+    int deviceId;
+    std::string location;
+};
+
+// the location of every device the X server knows the device node of
+liberror::Result<std::vector<DeviceLocation>> get_device_locations();
+
+// a property the X server keeps for a device, its values written out the way xinput list-props shows them
+struct DeviceProperty
+{
+    std::string name;
+    std::string type;
+    std::vector<std::string> values;
+};
+
+struct DeviceProperties
+{
+    std::string deviceName;
+    std::vector<DeviceProperty> properties;
+};
+
+// every property of every device the wacom driver owns, all read over a single connection instead of
+// one xsetwacom process per parameter. the requests are pipelined, so it takes a few round trips in total
+liberror::Result<std::vector<DeviceProperties>> get_device_properties();
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Input.hpp"
+
+#include <libwacom/Device.hpp>
+#include <nlohmann/json.hpp>
+
+#include <optional>
+
+struct OutputMapping
+{
+    libwacom::Area deviceArea; // device units
+    libwacom::Area outputArea; // screen pixels
+};
+
+// summarises a capture into its report rate, interval jitter, dropped and coalesced reports and how long
+// the raw and cooked events took to get here after the server stamped them. when the mapping applied to the device is known it also reports
+// how far the cooked positions land from where that mapping should have put them.
+nlohmann::ordered_json analyse_input_capture(InputCapture const& capture, std::optional<OutputMapping> const& mapping);
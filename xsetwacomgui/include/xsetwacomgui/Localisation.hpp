@@ -22,11 +22,13 @@ public:
 
         Save,
         Save_Apply,
+        Save_Device_Differs,
 
         MenuBar_Settings,
         MenuBar_Settings_Application,
         MenuBar_Other,
         MenuBar_Other_Goddess,
+        MenuBar_Other_Memory,
 
         Popup_Settings_Tabs_Appearance_Title,
         Popup_Settings_Tabs_Appearance_Theme,
@@ -37,10 +39,27 @@ public:
         Popup_Settings_Tabs_Display_Scale,
         Popup_Settings_Tabs_Language_Title,
         Popup_Settings_Tabs_Language_Language,
+        Popup_Memory_Resident,
+        Popup_Memory_Allocations,
+        Popup_Memory_Subsystem,
+        Popup_Memory_Cpu,
+        Popup_Memory_Gpu,
 
         Tabs_Tablet_Title,
         Tabs_Tablet_Device,
         Tabs_Tablet_PressureCurve,
+        Tabs_Tablet_Strokes,
+        Tabs_Tablet_Strokes_None,
+        Tabs_Tablet_Strokes_Record,
+        Tabs_Tablet_Strokes_Stop,
+        Tabs_Tablet_Strokes_Evaluated,
+        Tabs_Tablet_Calibrate,
+        Tabs_Tablet_Calibration_Light,
+        Tabs_Tablet_Calibration_Medium,
+        Tabs_Tablet_Calibration_Firm,
+        Tabs_Tablet_Calibration_Samples,
+        Tabs_Tablet_Calibration_Next,
+        Tabs_Tablet_Calibration_Cancel,
         Tabs_Tablet_Width,
         Tabs_Tablet_Height,
         Tabs_Tablet_OffsetX,
@@ -58,10 +77,31 @@ public:
         Tabs_Monitor_FullArea,
         Tabs_Monitor_ForceProportions,
 
+        Tabs_Input_Title,
+        Tabs_Input_Unavailable,
+        Tabs_Input_Rate,
+        Tabs_Input_Dropped,
+        Tabs_Input_Position,
+        Tabs_Input_Pressure,
+        Tabs_Input_Tilt,
+        Tabs_Input_Raw,
+        Tabs_Input_Curve,
+        Tabs_Driver_Title,
+        Tabs_Driver_Refresh,
+        Tabs_Driver_Search,
+        Tabs_Driver_Read,
+        Tabs_Driver_Reading,
+        Tabs_Driver_Device,
+        Tabs_Driver_Property,
+        Tabs_Driver_Type,
+        Tabs_Driver_Value,
+
         Toast_Application_Settings_Saved,
         Toast_Device_Settings_Saved,
         Toast_Device_Settings_Load_Failed,
         Toast_Device_Settings_Missing,
+        Toast_Pressure_Curve_Fitted,
+        Toast_Pressure_Curve_Fit_Failed,
     };
 
     static auto& the()
@@ -71,5 +111,8 @@ public:
     }
 
     static liberror::Result<char const*> get(ApplicationSettings::Language language, LocalisedMessage id);
+
+    // drops the tables of every language but the given one
+    static void release_unused(ApplicationSettings::Language language);
 };
 
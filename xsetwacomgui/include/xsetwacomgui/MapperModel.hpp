@@ -0,0 +1,41 @@
+#pragma once
+
+#include <imgui/imgui_internal.hpp>
+#include <libwacom/Device.hpp>
+
+#include <array>
+#include <cstddef>
+
+// what an area mapper shows, kept apart from the widget so that any number of them can be on screen. the
+// anchors are only derived from the area when the area changes from elsewhere (the text fields, another
+// device, the driver). a drag writes the area from the anchors without deriving them back, so the two never
+// drift apart through repeated round trips.
+struct MapperModel
+{
+    libwacom::Area area { -1, -1, -1, -1 };        // what the anchors stand for
+    libwacom::Area defaultArea { -1, -1, -1, -1 }; // the whole of the device or monitor
+    ImVec2 anchors[4] {};                          // top left, bottom left, top right and bottom right in [0, 1]
+    ImRect frame {};                               // where the widget was last drawn, in pixels
+    size_t version = 0;                            // bumped whenever the anchors or the frame move
+};
+
+// derives the anchors again, but only when the area or the default area differ from what they stand for
+void sync_mapper_model(MapperModel& model, libwacom::Area const& area, libwacom::Area const& defaultArea);
+
+// the widget moved the anchors, returns the area they now stand for
+libwacom::Area commit_mapper_model(MapperModel& model);
+
+void set_mapper_frame(MapperModel& model, ImRect const& frame);
+
+// an anchor, or any point in the same space, in pixels
+ImVec2 to_mapper_pixels(MapperModel const& model, ImVec2 anchor);
+
+// the lines between the corners of two mappers, recomputed only when either of them moved
+struct MapperConnection
+{
+    size_t fromVersion = static_cast<size_t>(-1);
+    size_t toVersion = static_cast<size_t>(-1);
+    std::array<std::array<ImVec2, 2>, 4> lines {};
+};
+
+void update_mapper_connection(MapperConnection& connection, MapperModel const& from, MapperModel const& to);
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <liberror/Result.hpp>
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+struct MemoryUsage
+{
+    size_t cpu;
+    size_t gpu;
+};
+
+// subsystems report what they currently hold whenever it changes. only the big allocations are
+// counted, so the sum stays below the resident size.
+void set_memory_usage(std::string_view subsystem, MemoryUsage usage);
+
+struct MemoryReport
+{
+    size_t residentBytes;
+    size_t anonymousBytes;
+    size_t fileBytes;
+    std::vector<std::pair<std::string, MemoryUsage>> subsystems;
+};
+
+liberror::Result<MemoryReport> get_memory_report();
+void print_memory_report(MemoryReport const& report);
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <liberror/Result.hpp>
+
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// looks up "--name" or "--name=value" and returns the value, which is empty for the former
+std::optional<std::string_view> find_option(std::vector<std::string_view> const& arguments, std::string_view name);
+
+liberror::Result<size_t> parse_count(std::string_view value);
+
+// parses "a,b,c,d" into exactly as many numbers as the output holds
+liberror::Result<void> parse_numbers(std::string_view value, std::span<float> output);
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <libwacom/Device.hpp>
+
+#include <span>
+#include <vector>
+
+// the wacom driver does not evaluate the pressure bezier per event. it rasterises the curve through
+// (0, 0), (minX, minY), (maxX, maxY) and (1, 1) into a table indexed by the raw pressure once, every
+// time the curve is set, and looks events up in it. these mirror that so previews match the driver.
+std::vector<float> make_pressure_curve_table(libwacom::Pressure const& pressure, size_t size = 1024);
+float evaluate_pressure_curve(std::span<float const> table, float pressure);
+
+// the same lookup over a whole stroke, kept free of branches so that the compiler vectorises it
+void evaluate_pressure_curve(std::span<float const> table, std::span<float const> pressure, std::span<float> output);
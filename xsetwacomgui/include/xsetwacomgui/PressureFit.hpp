@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Strokes.hpp"
+
+#include <libwacom/Device.hpp>
+#include <liberror/Result.hpp>
+#include <nlohmann/json.hpp>
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+// what a calibration aims for: strokes drawn lightly come out at a fifth of the range, medium ones at
+// half of it and firm ones close to the top, whatever raw pressure the hand drawing them happens to use
+inline constexpr std::array<float, 3> CALIBRATION_TARGETS { 0.2f, 0.5f, 0.85f };
+
+struct PressureFit
+{
+    libwacom::Pressure curve;
+    double error;      // root mean square distance from the targets
+    size_t iterations;
+};
+
+// the bezier itself rather than the driver table, which is a staircase that an optimiser can't follow
+double evaluate_pressure_bezier(libwacom::Pressure const& curve, double pressure);
+
+// fits the four control points to the strokes drawn for each of the targets with levenberg-marquardt,
+// starting from the given curve. the ends of every stroke, where the pen lands and lifts, are left out.
+liberror::Result<PressureFit> fit_pressure_curve(std::span<Stroke const, CALIBRATION_TARGETS.size()> strokes, libwacom::Pressure const& initial);
+
+// strokes as a hand would draw them for the targets if the given curve was the one that suits it, so
+// that a fit has something to be checked against
+std::array<Stroke, CALIBRATION_TARGETS.size()> make_synthetic_calibration(libwacom::Pressure const& hand, uint32_t seed);
+
+// fits the synthetic calibrations of as many random hands and reports how long each fit took, how many
+// iterations it needed and how far from the targets it ended up
+nlohmann::ordered_json benchmark_pressure_fit(size_t runs);
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <liberror/Result.hpp>
+
+#include <chrono>
+#include <stop_token>
+#include <string>
+#include <vector>
+
+struct ProcessOptions
+{
+    std::chrono::milliseconds timeout { 5000 };
+    std::stop_token stopToken {};
+};
+
+struct ProcessResult
+{
+    int exitStatus;
+    std::string output;
+    std::string error;
+    std::chrono::nanoseconds duration; // from the spawn until it was reaped
+};
+
+// spawns argv[0] from PATH without a shell and collects its stdout and stderr, the process is killed
+// once the timeout expires or a stop is requested, which is then reported as an error
+liberror::Result<ProcessResult> run_process(std::vector<std::string> const& argv, ProcessOptions const& options = {});
+
+// runs every command at the same time, the results are in the same order as the commands
+std::vector<liberror::Result<ProcessResult>> run_processes(std::vector<std::vector<std::string>> const& commands, ProcessOptions const& options = {});
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Backend.hpp"
+#include "Environment.hpp"
+#include "Monitor.hpp"
+#include "WindowFocus.hpp"
+
+#include <liberror/Result.hpp>
+
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+inline std::filesystem::path PROFILE_RULES_FILE = get_application_config_path() / "profiles.json";
+inline std::filesystem::path PROFILES_PATH = get_application_config_path() / "profiles";
+
+struct Profile
+{
+    std::string name;
+    std::vector<DeviceState> states; // one per device of the tablet
+};
+
+// every profile a rule can pick, read and resolved against the tablet and the monitors up front so that a focus
+// change only costs a lookup
+struct ProfileRules
+{
+    std::vector<Profile> profiles;
+    std::unordered_map<std::string, size_t> rules; // lowercase window class to profile
+    size_t fallback;
+};
+
+liberror::Result<ProfileRules> compile_profile_rules(std::filesystem::path const& file, Tablet const& tablet, std::vector<Monitor> const& monitors);
+
+// the class of the window is looked up before its instance, the fallback is used when neither has a rule
+Profile const& match_profile(ProfileRules const& rules, WindowClass const& windowClass);
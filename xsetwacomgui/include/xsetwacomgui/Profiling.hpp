@@ -0,0 +1,40 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <span>
+
+struct FrameSample
+{
+    std::chrono::nanoseconds duration;
+    size_t allocations;     // made by imgui
+    size_t heapAllocations; // every call to operator new, see COUNTING_HEAP_ALLOCATIONS
+};
+
+struct FrameStatistics
+{
+    size_t frames;
+    std::chrono::nanoseconds mean, min, p50, p90, p99, max;
+    double allocationsMean;
+    size_t allocationsMin, allocationsMax;
+    double heapAllocationsMean;
+    size_t heapAllocationsMax;
+};
+
+// the global operator new is only replaced by a counting one in builds configured with
+// ENABLE_ALLOCATION_COUNTING (on in the debug preset), everywhere else the count stays at zero
+#ifdef COUNT_ALLOCATIONS
+inline constexpr bool COUNTING_HEAP_ALLOCATIONS = true;
+#else
+inline constexpr bool COUNTING_HEAP_ALLOCATIONS = false;
+#endif
+
+size_t get_heap_allocation_count();
+
+// routes every imgui allocation through a counter, must be called before ImGui::CreateContext
+void install_imgui_allocation_counter();
+size_t get_imgui_allocation_count();
+size_t get_imgui_allocated_bytes();
+
+FrameStatistics compute_frame_statistics(std::span<FrameSample const> samples);
+void print_frame_statistics(FrameStatistics const& statistics, std::span<FrameSample const> samples);
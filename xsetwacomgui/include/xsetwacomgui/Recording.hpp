@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Backend.hpp"
+#include "Profiling.hpp"
+#include "Settings.hpp"
+
+#include <imgui/imgui.hpp>
+#include <liberror/Result.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+struct RecordedFrame
+{
+    float deltaTime;
+    ImVec2 mousePosition;
+    uint8_t mouseButtons;
+    ImVec2 mouseWheel;
+    std::vector<std::pair<ImGuiKey, bool>> keys;
+    std::vector<ImWchar> characters;
+    FrameSample sample;
+};
+
+enum class BackendCall : uint8_t
+{
+    GET_AVAILABLE_MONITORS,
+    GET_AVAILABLE_DEVICES,
+    GET_DEVICE_PRODUCT_ID,
+    GET_STYLUS_DEFAULT_AREA,
+    GET_STYLUS_AREA,
+    GET_STYLUS_PRESSURE_CURVE,
+    SET_STYLUS_AREA,
+    SET_STYLUS_PRESSURE_CURVE,
+    SET_STYLUS_OUTPUT_FROM_DISPLAY_AREA,
+    OPEN_STYLUS_INPUT,
+    WATCH_DEVICE_PROPERTIES,
+    GET_DEVICE_PROPERTIES,
+    GET_DEVICE_LOCATIONS,
+};
+
+struct RecordedCall
+{
+    BackendCall call;
+    std::string response;
+};
+
+// everything a gui session depends on: its input per frame, the answers of the backend and the
+// settings it started from, along with how long each frame took
+struct Session
+{
+    ImVec2 windowSize;
+    float scale;
+    ApplicationSettings applicationSettings;
+    std::optional<std::string> deviceSettingsFile;
+
+    std::vector<RecordedFrame> frames;
+
+    std::mutex callsMutex;
+    std::vector<RecordedCall> calls;
+};
+
+liberror::Result<void> save_session(std::filesystem::path const& path, Session& session);
+liberror::Result<void> load_session(std::filesystem::path const& path, Session& session);
+
+// passes every call through and keeps the response in the session
+Backend make_recording_backend(Backend backend, Session& session);
+// answers with the responses kept in the session in the order they were given. anything the session
+// has no response for, say a call a newer build added, is answered by the fallback and counted.
+Backend make_replay_backend(Session& session, Backend fallback, size_t& unrecordedCalls);
+
+// the input imgui took in this frame, keys are recorded as they change so their previous state is kept
+RecordedFrame capture_frame_input(ImGuiIO const& io, std::vector<bool>& keysDown);
+void push_frame_input(ImGuiIO& io, RecordedFrame const& frame);
+
+void print_replay_comparison(std::span<RecordedFrame const> recorded, std::span<FrameSample const> replayed, size_t unrecordedCalls);
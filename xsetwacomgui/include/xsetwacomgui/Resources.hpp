@@ -0,0 +1,27 @@
+#pragma once
+
+#include <liberror/Result.hpp>
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct PackedResource
+{
+    char const* name;
+    size_t offset;
+    size_t size;
+};
+
+// the contents of resources/, compiled into the binary at build time
+std::span<unsigned char const> get_packed_data();
+std::span<PackedResource const> get_packed_index();
+
+// a file with the same path under the data path takes precedence over the packed one, so resources can
+// still be replaced without rebuilding. the returned memory lives until the program exits.
+liberror::Result<std::span<unsigned char const>> get_resource(std::string_view name);
+
+// paths of the resources directly inside the directory, packed or not
+std::vector<std::string> list_resources(std::string_view directory);
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+
+// lock-free queue for exactly one producer thread and one consumer thread. neither side ever waits
+// on the other: push fails when the buffer is full and pop fails when it is empty.
+template <class T, size_t Capacity>
+class RingBuffer
+{
+    static_assert(std::has_single_bit(Capacity), "RingBuffer capacity must be a power of two");
+
+private:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head = 0;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail = 0;
+    alignas(CACHE_LINE_SIZE) std::array<T, Capacity> data {};
+
+public:
+    bool push(T const& value)
+    {
+        auto const position = head.load(std::memory_order_relaxed);
+        if (position - tail.load(std::memory_order_acquire) == Capacity) return false;
+        data[position & (Capacity - 1)] = value;
+        head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& value)
+    {
+        auto const position = tail.load(std::memory_order_relaxed);
+        if (position == head.load(std::memory_order_acquire)) return false;
+        value = data[position & (Capacity - 1)];
+        tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+};
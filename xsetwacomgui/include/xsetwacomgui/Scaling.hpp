@@ -6,10 +6,19 @@ inline float& the_scale()
     return scale;
 }
 
+// bumped on every change of the scale, so that values derived from it know when to be recomputed
+inline unsigned& the_scale_generation()
+{
+    static unsigned generation = 0;
+    return generation;
+}
+
 inline void set_scale(float value)
 {
     auto& scale = the_scale();
+    if (scale == value) return;
     scale = value;
+    the_scale_generation() += 1;
 }
 
 inline float operator""_scaled(unsigned long long i)
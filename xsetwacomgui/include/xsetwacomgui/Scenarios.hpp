@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Settings.hpp"
+
+#include <imgui/imgui.hpp>
+#include <liberror/Result.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+// what happens right before one frame of a scenario is built, and whether the frame is captured after it
+struct ScenarioFrame
+{
+    std::optional<ImVec2> mouse;
+    std::optional<bool> leftButton;
+    std::optional<std::string> theme;
+    std::optional<ApplicationSettings::Language> language;
+    std::optional<float> scale;
+    std::optional<std::string> capture;
+};
+
+// a script of pointer moves, clicks and settings changes, expanded into the frames it takes. see
+// "documentation/11 - UI Scenarios.md" for the format.
+struct Scenario
+{
+    std::string name;
+    double budgetUs;         // no frame but the first may take longer to build
+    int tolerance;           // how far apart a channel may be before the pixel counts as different
+    double differingPixels;  // the fraction of differing pixels a capture may have
+    std::vector<ScenarioFrame> frames;
+};
+
+liberror::Result<Scenario> load_scenario(std::filesystem::path const& path);
+
+// every scenario in the directory, sorted by name
+std::vector<std::filesystem::path> find_scenarios(std::filesystem::path const& directory);
+
+// the colours are in the order imgui uses, red in the lowest byte. images are stored as binary ppm.
+struct Image
+{
+    int width, height;
+    std::vector<uint32_t> pixels;
+};
+
+liberror::Result<void> save_image(std::filesystem::path const& path, Image const& image);
+liberror::Result<Image> load_image(std::filesystem::path const& path);
+
+struct ImageComparison
+{
+    size_t differingPixels;
+    int maxDifference;
+    Image difference; // the differing pixels in red over a faded copy of the expected image
+};
+
+// images of different sizes never match, every pixel counts as differing
+ImageComparison compare_images(Image const& expected, Image const& actual, int tolerance);
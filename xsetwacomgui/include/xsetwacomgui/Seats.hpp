@@ -0,0 +1,24 @@
+#pragma once
+
+#include "Environment.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// a seat with a tablet of its own keeps its settings here, named after the number of its display
+inline std::filesystem::path SEAT_SETTINGS_PATH = get_application_config_path() / "seats";
+
+// the displays whose sockets the X servers made in the directory, as ":0", ":1" and so on
+std::vector<std::string> find_displays(std::filesystem::path const& socketDirectory = "/tmp/.X11-unix");
+
+// "seats/1.json" for ":1" when there is one, otherwise the settings every seat shares
+std::filesystem::path get_seat_settings_file(std::string_view display);
+
+// loads the settings of every display the way --no-gui does, each in a process of its own so that all of
+// them are connected to and written at the same time. the report tells how each display went and how long
+// it took, the whole of it takes about as long as the slowest display.
+nlohmann::ordered_json apply_settings_to_displays(std::vector<std::string> const& displays);
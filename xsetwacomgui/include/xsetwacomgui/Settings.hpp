@@ -5,9 +5,20 @@
 #include <imgui/imgui_internal.hpp>
 #include <libwacom/Device.hpp>
 
+#include <map>
+#include <optional>
+#include <string>
+
 inline std::filesystem::path DEVICE_SETTINGS_FILE = get_application_config_path() / "device.json";
 inline std::filesystem::path APPLICATION_SETTINGS_FILE = get_application_config_path() / "application.json";
 
+// what one kind of device of the tablet takes instead of the settings of the stylus
+struct DeviceOverride
+{
+    std::optional<libwacom::Area> deviceArea;
+    std::optional<libwacom::Pressure> devicePressure;
+};
+
 struct DeviceSettings
 {
     std::string deviceName;
@@ -19,18 +30,18 @@ struct DeviceSettings
     libwacom::Area monitorArea;
     bool monitorForceFullArea;
     bool monitorForceAspectRatio;
+    std::map<std::string, DeviceOverride> deviceOverrides; // by device kind, e.g. ERASER
 };
 
-bool load_device_settings(DeviceSettings& settings);
+bool load_device_settings(DeviceSettings& settings, std::filesystem::path const& file = DEVICE_SETTINGS_FILE);
 bool save_device_settings(DeviceSettings const& settings);
 
 struct ApplicationSettings
 {
-    ENUM_CLASS(Theme, DARK, LIGHT)
     ENUM_CLASS(Language, EN_US, PT_BR, RU_RU)
 
     float scale;
-    Theme theme;
+    std::string theme;
     Language language;
     std::string font;
 };
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <imgui/imgui.hpp>
+#include <liberror/Result.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+struct GLFWwindow;
+struct PresentTarget;
+
+// draws imgui on the cpu and presents it with XPutImage, for sessions where there is no usable opengl
+// (ssh -X, vnc, thin clients without a gpu, xvfb). only the tiles that changed since the last frame are
+// sent to the server, through shared memory when the server is on the same machine.
+class SoftwareRenderer
+{
+private:
+    static constexpr int TILE_SIZE = 32;
+
+    struct Texture
+    {
+        int width, height;
+        std::vector<uint32_t> pixels; // rgba, as imgui hands them over
+    };
+
+    std::unique_ptr<PresentTarget> target; // the window and the image that is put into it, none when off screen
+
+    int width = 0, height = 0;
+    std::vector<uint32_t> frame {};    // abgr, the same order as the colours imgui uses
+    std::vector<uint32_t> previous {}; // what the server was last sent
+    bool fullDamage = true;
+
+    std::unordered_map<ImTextureID, Texture> textures {};
+    ImTextureID nextTexture = 1;
+
+    SoftwareRenderer();
+
+    liberror::Result<void> resize(int newWidth, int newHeight);
+    void draw_list(ImDrawList const& list, ImVec2 origin);
+    void present();
+
+public:
+    // the window has to be created without a client api
+    static liberror::Result<std::unique_ptr<SoftwareRenderer>> open(GLFWwindow* window);
+    // only draws into memory, for the frames to be read back with pixels()
+    static std::unique_ptr<SoftwareRenderer> open_offscreen();
+    ~SoftwareRenderer();
+
+    SoftwareRenderer(SoftwareRenderer const&) = delete;
+    SoftwareRenderer& operator=(SoftwareRenderer const&) = delete;
+
+    ImTextureID create_texture(int textureWidth, int textureHeight, uint32_t const* pixels);
+    void destroy_texture(ImTextureID texture);
+
+    liberror::Result<void> render(ImDrawData const& drawData);
+
+    // the server forgets what was drawn when the window gets covered, everything is sent again on the next frame
+    void invalidate() { fullDamage = true; }
+
+    // the last frame rendered, frame_width() by frame_height() pixels in the order imgui uses
+    std::span<uint32_t const> pixels() const { return frame; }
+    int frame_width() const { return width; }
+    int frame_height() const { return height; }
+};
+
+// the software renderer in use, or nullptr while drawing through opengl
+SoftwareRenderer*& the_software_renderer();
+
+// textures are created on whichever renderer is in use, the pixels are rgba
+ImTextureID create_texture(int width, int height, uint32_t const* pixels);
+void destroy_texture(ImTextureID texture);
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Environment.hpp"
+
+#include <liberror/Result.hpp>
+
+#include <filesystem>
+#include <vector>
+
+inline std::filesystem::path STROKES_PATH = get_application_config_path() / "strokes";
+
+// the stylus as recorded while drawing, one sample per event. every field is its own array so that a whole
+// stroke can be run through a pressure curve at once.
+struct Stroke
+{
+    std::vector<float> time;     // seconds since the first sample
+    std::vector<float> x, y;     // [0, 1] over the whole device
+    std::vector<float> pressure; // raw, [0, 1]
+
+    size_t size() const { return pressure.size(); }
+    void push(float sampleTime, float sampleX, float sampleY, float samplePressure);
+};
+
+// the file takes 10 bytes per sample: the time in microseconds and the rest quantised to 16 bits
+liberror::Result<void> save_stroke(std::filesystem::path const& path, Stroke const& stroke);
+liberror::Result<Stroke> load_stroke(std::filesystem::path const& path);
+
+// the strokes saved under STROKES_PATH, sorted by name
+std::vector<std::filesystem::path> get_saved_strokes();
+
+// the first stroke-N.bin that is not taken yet
+std::filesystem::path make_stroke_path();
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <imgui/imgui.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// colours of the custom widgets, packed once whenever a theme is applied instead of on every draw call
+struct ThemePalette
+{
+    ImU32 mapperBackground;
+    ImU32 mapperBackgroundContrast;
+    ImU32 mapperGrid;
+    ImU32 mapperGrab;
+    ImU32 mapperGrabActive;
+};
+
+// "DARK" and "LIGHT" are built in, anything else comes from the json palettes under the themes directory
+std::vector<std::string> const& get_available_themes();
+
+// rewrites the style of the current context, unknown themes fall back to "DARK"
+void apply_theme(std::string_view name);
+
+ThemePalette const& the_theme_palette();
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <liberror/Result.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+// spans are kept in memory, in a buffer per thread, and only written out as a chrome trace once
+// tracing stops, so that recording them barely affects the timings being recorded
+void start_tracing(std::filesystem::path path);
+liberror::Result<void> stop_tracing();
+
+class TraceSpan
+{
+private:
+    char const* name;
+    std::chrono::steady_clock::time_point begin;
+    std::vector<std::pair<char const*, std::string>> arguments;
+    bool active;
+
+public:
+    explicit TraceSpan(char const* name);
+    ~TraceSpan();
+
+    TraceSpan(TraceSpan const&) = delete;
+    TraceSpan& operator=(TraceSpan const&) = delete;
+
+    // names must outlive the trace, string literals are expected
+    void argument(char const* key, std::string value);
+    void end();
+};
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+#define TRACE_SCOPE(name) TraceSpan TRACE_CONCAT(traceSpan, __LINE__) { name }
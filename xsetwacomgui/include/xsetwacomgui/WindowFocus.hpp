@@ -0,0 +1,20 @@
+#pragma once
+
+#include <liberror/Result.hpp>
+
+#include <functional>
+#include <stop_token>
+#include <string>
+
+// the WM_CLASS of a window, both empty when nothing has focus
+struct WindowClass
+{
+    std::string instance;
+    std::string name;
+
+    bool operator==(WindowClass const&) const = default;
+};
+
+// blocks on the X connection until a stop is requested and calls the handler with the class of the
+// focused window, once right away and then whenever _NET_ACTIVE_WINDOW or the class of that window change
+liberror::Result<void> watch_window_focus(std::stop_token const& token, std::function<void(WindowClass const&)> const& handler);
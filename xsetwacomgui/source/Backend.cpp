@@ -0,0 +1,357 @@
+#include "Backend.hpp"
+
+#include "Trace.hpp"
+
+#include <liberror/Try.hpp>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <future>
+#include <mutex>
+
+template <class Result>
+static Result trace_result(TraceSpan& span, Result result)
+{
+    span.argument("status", result.has_value() ? "ok" : result.error().message());
+    return result;
+}
+
+static std::string format_area(libwacom::Area const& area)
+{
+    return fmt::format("{} {} {} {}", area.offsetX, area.offsetY, area.width, area.height);
+}
+
+Backend make_system_backend()
+{
+    return {
+        .get_available_monitors = [] () -> liberror::Result<std::vector<Monitor>> {
+            TRACE_SCOPE("get_available_monitors");
+            return TRY(::get_available_monitors());
+        },
+        .get_available_devices = [] () -> liberror::Result<std::vector<libwacom::Device>> {
+            TraceSpan span { "libwacom::get_available_devices" };
+            return TRY(trace_result(span, libwacom::get_available_devices()));
+        },
+        .get_device_product_id = [] (std::string_view deviceName) -> liberror::Result<ProductId> {
+            return ::get_device_product_id(deviceName);
+        },
+        .get_device_locations = [] () -> liberror::Result<std::vector<DeviceLocation>> {
+            TraceSpan span { "get_device_locations" };
+            return trace_result(span, ::get_device_locations());
+        },
+        .get_device_properties = [] () -> liberror::Result<std::vector<DeviceProperties>> {
+            TraceSpan span { "get_device_properties" };
+            return trace_result(span, ::get_device_properties());
+        },
+        .get_stylus_default_area = [] (Backend::DeviceId id) -> liberror::Result<libwacom::Area> {
+            TraceSpan span { "libwacom::get_stylus_default_area" };
+            span.argument("device", fmt::format("{}", id));
+            return TRY(trace_result(span, libwacom::get_stylus_default_area(id)));
+        },
+        .get_stylus_area = [] (Backend::DeviceId id) -> liberror::Result<libwacom::Area> {
+            TraceSpan span { "libwacom::get_stylus_area" };
+            span.argument("device", fmt::format("{}", id));
+            return TRY(trace_result(span, libwacom::get_stylus_area(id)));
+        },
+        .get_stylus_pressure_curve = [] (Backend::DeviceId id) -> liberror::Result<libwacom::Pressure> {
+            TraceSpan span { "libwacom::get_stylus_pressure_curve" };
+            span.argument("device", fmt::format("{}", id));
+            return TRY(trace_result(span, libwacom::get_stylus_pressure_curve(id)));
+        },
+        .set_stylus_area = [] (Backend::DeviceId id, libwacom::Area area) -> liberror::Result<void> {
+            TraceSpan span { "libwacom::set_stylus_area" };
+            span.argument("device", fmt::format("{}", id));
+            span.argument("area", format_area(area));
+            TRY(trace_result(span, libwacom::set_stylus_area(id, area)));
+            return {};
+        },
+        .set_stylus_pressure_curve = [] (Backend::DeviceId id, libwacom::Pressure pressure) -> liberror::Result<void> {
+            TraceSpan span { "libwacom::set_stylus_pressure_curve" };
+            span.argument("device", fmt::format("{}", id));
+            span.argument("pressure", fmt::format("{} {} {} {}", pressure.minX, pressure.minY, pressure.maxX, pressure.maxY));
+            TRY(trace_result(span, libwacom::set_stylus_pressure_curve(id, pressure)));
+            return {};
+        },
+        .set_stylus_output_from_display_area = [] (Backend::DeviceId id, libwacom::Area area) -> liberror::Result<void> {
+            TraceSpan span { "libwacom::set_stylus_output_from_display_area" };
+            span.argument("device", fmt::format("{}", id));
+            span.argument("area", format_area(area));
+            TRY(trace_result(span, libwacom::set_stylus_output_from_display_area(id, area)));
+            return {};
+        },
+        .open_stylus_input = [] (std::string_view deviceName) -> liberror::Result<std::unique_ptr<StylusInput>> {
+            TraceSpan span { "StylusInput::open" };
+            span.argument("device", std::string(deviceName));
+            return trace_result(span, StylusInput::open(deviceName));
+        },
+        .watch_device_properties = [] (std::string_view deviceName) -> liberror::Result<std::unique_ptr<DevicePropertyWatcher>> {
+            TraceSpan span { "DevicePropertyWatcher::open" };
+            span.argument("device", std::string(deviceName));
+            return trace_result(span, DevicePropertyWatcher::open(deviceName));
+        },
+    };
+}
+
+Backend make_fake_backend()
+{
+    static constexpr libwacom::Area FAKE_DEVICE_AREA { 0, 0, 15200, 9500 };
+
+    return {
+        .get_available_monitors = [] () -> liberror::Result<std::vector<Monitor>> {
+            return std::vector<Monitor> {
+                { .id = 0, .primary = true, .offsetX = 0, .offsetY = 0, .width = 1920, .height = 1080, .name = "FAKE-1" },
+                { .id = 1, .primary = false, .offsetX = 1920, .offsetY = 0, .width = 2560, .height = 1440, .name = "FAKE-2" },
+            };
+        },
+        .get_available_devices = [] () -> liberror::Result<std::vector<libwacom::Device>> {
+            libwacom::Device stylus {};
+            stylus.id = 0;
+            stylus.name = "Fake Tablet Pen stylus";
+            stylus.kind = libwacom::Device::Kind::STYLUS;
+
+            libwacom::Device eraser {};
+            eraser.id = 1;
+            eraser.name = "Fake Tablet Pen eraser";
+            eraser.kind = libwacom::Device::Kind::ERASER;
+
+            return std::vector<libwacom::Device> { stylus, eraser };
+        },
+        .get_device_product_id = [] (std::string_view) -> liberror::Result<ProductId> {
+            return ProductId { 0x056a, 0x0000 };
+        },
+        .get_device_locations = [] () -> liberror::Result<std::vector<DeviceLocation>> {
+            return std::vector<DeviceLocation> { { 0, "usb-fake-1" }, { 1, "usb-fake-1" } };
+        },
+        .get_device_properties = [] () -> liberror::Result<std::vector<DeviceProperties>> {
+            auto const make_properties = [] (std::string name, std::string tool) {
+                return DeviceProperties { std::move(name), {
+                    { "Coordinate Transformation Matrix", "FLOAT", { "1", "0", "0", "0", "1", "0", "0", "0", "1" } },
+                    { "Device Enabled", "INTEGER", { "1" } },
+                    { "Wacom Pressurecurve", "INTEGER", { "0", "0", "100", "100" } },
+                    { "Wacom Tablet Area", "INTEGER", { "0", "0", "15200", "9500" } },
+                    { "Wacom Tool Type", "ATOM", { std::move(tool) } },
+                } };
+            };
+
+            return std::vector<DeviceProperties> {
+                make_properties("Fake Tablet Pen stylus", "STYLUS"),
+                make_properties("Fake Tablet Pen eraser", "ERASER"),
+            };
+        },
+        .get_stylus_default_area = [] (Backend::DeviceId) -> liberror::Result<libwacom::Area> {
+            return FAKE_DEVICE_AREA;
+        },
+        .get_stylus_area = [] (Backend::DeviceId) -> liberror::Result<libwacom::Area> {
+            return FAKE_DEVICE_AREA;
+        },
+        .get_stylus_pressure_curve = [] (Backend::DeviceId) -> liberror::Result<libwacom::Pressure> {
+            return libwacom::Pressure { 0, 0, 1, 1 };
+        },
+        .set_stylus_area = [] (Backend::DeviceId, libwacom::Area) -> liberror::Result<void> {
+            return {};
+        },
+        .set_stylus_pressure_curve = [] (Backend::DeviceId, libwacom::Pressure) -> liberror::Result<void> {
+            return {};
+        },
+        .set_stylus_output_from_display_area = [] (Backend::DeviceId, libwacom::Area) -> liberror::Result<void> {
+            return {};
+        },
+        .open_stylus_input = [] (std::string_view) -> liberror::Result<std::unique_ptr<StylusInput>> {
+            return liberror::make_error("The fake backend has no stylus input");
+        },
+        .watch_device_properties = [] (std::string_view) -> liberror::Result<std::unique_ptr<DevicePropertyWatcher>> {
+            return liberror::make_error("The fake backend has no device properties");
+        },
+    };
+}
+
+static std::string get_tablet_name(std::string_view deviceName)
+{
+    static constexpr std::array KINDS { " stylus", " eraser", " cursor", " touch", " pad" };
+    static constexpr std::array TOOLS { " Pen", " Finger", " Pad" };
+
+    auto const kind = std::ranges::find_if(KINDS, [&] (std::string_view suffix) { return deviceName.ends_with(suffix); });
+    if (kind == KINDS.end()) return std::string(deviceName);
+
+    deviceName.remove_suffix(std::string_view(*kind).size());
+
+    auto const tool = std::ranges::find_if(TOOLS, [&] (std::string_view suffix) { return deviceName.ends_with(suffix); });
+    if (tool != TOOLS.end()) deviceName.remove_suffix(std::string_view(*tool).size());
+
+    return std::string(deviceName);
+}
+
+std::vector<Tablet> group_devices_by_tablet(std::vector<libwacom::Device> const& devices)
+{
+    // without the locations every tablet of a model ends up in one, as it always did before
+    auto const locations = the_backend().get_device_locations().value_or(std::vector<DeviceLocation> {});
+
+    std::vector<Tablet> tablets {};
+
+    for (auto const& device : devices)
+    {
+        auto const name = get_tablet_name(device.name);
+
+        auto const location = std::ranges::find(locations, device.id, &DeviceLocation::deviceId);
+        auto const where = location != locations.end() ? location->location : std::string {};
+
+        auto tablet = std::ranges::find_if(tablets, [&] (Tablet const& candidate) { return candidate.name == name && candidate.location == where; });
+        if (tablet == tablets.end()) tablet = tablets.insert(tablets.end(), Tablet { name, where, {} });
+
+        tablet->devices.push_back(device);
+    }
+
+    for (auto& tablet : tablets)
+    {
+        std::ranges::stable_partition(tablet.devices, [] (libwacom::Device const& device) { return device.kind == libwacom::Device::Kind::STYLUS; });
+    }
+
+    return tablets;
+}
+
+Tablet find_tablet(std::vector<Tablet> const& tablets, libwacom::Device const& device)
+{
+    for (auto const& tablet : tablets)
+    {
+        if (std::ranges::any_of(tablet.devices, [&] (libwacom::Device const& member) { return member.id == device.id && member.name == device.name; }))
+            return tablet;
+    }
+
+    return { device.name, {}, { device } };
+}
+
+DeviceState get_device_state(Monitor const& monitor, DeviceSettings const& settings)
+{
+    return {
+        .area = settings.deviceArea,
+        .pressure = settings.devicePressure,
+        .output = libwacom::Area {
+            settings.monitorArea.offsetX + monitor.offsetX,
+            settings.monitorArea.offsetY + monitor.offsetY,
+            settings.monitorArea.width,
+            settings.monitorArea.height,
+        },
+    };
+}
+
+std::vector<DeviceState> get_tablet_state(Tablet const& tablet, Monitor const& monitor, DeviceSettings const& settings)
+{
+    using Kind = libwacom::Device::Kind;
+
+    auto const stylus = get_device_state(monitor, settings);
+
+    std::vector<DeviceState> states {};
+
+    for (auto const& device : tablet.devices)
+    {
+        DeviceState state {};
+
+        if (device.kind == Kind::STYLUS || device.kind == Kind::ERASER) state = stylus;
+        else if (device.kind == Kind::CURSOR) state = { .area = stylus.area, .pressure = std::nullopt, .output = stylus.output };
+        else if (device.kind == Kind::TOUCH) state = { .area = std::nullopt, .pressure = std::nullopt, .output = stylus.output };
+
+        if (auto const deviceOverride = settings.deviceOverrides.find(device.kind.to_string()); deviceOverride != settings.deviceOverrides.end())
+        {
+            if (deviceOverride->second.deviceArea) state.area = deviceOverride->second.deviceArea;
+            if (deviceOverride->second.devicePressure) state.pressure = deviceOverride->second.devicePressure;
+        }
+
+        states.push_back(state);
+    }
+
+    return states;
+}
+
+static bool same_area(libwacom::Area const& lhs, libwacom::Area const& rhs)
+{
+    return lhs.offsetX == rhs.offsetX && lhs.offsetY == rhs.offsetY && lhs.width == rhs.width && lhs.height == rhs.height;
+}
+
+static bool same_pressure(libwacom::Pressure const& lhs, libwacom::Pressure const& rhs)
+{
+    return lhs.minX == rhs.minX && lhs.minY == rhs.minY && lhs.maxX == rhs.maxX && lhs.maxY == rhs.maxY;
+}
+
+template <class T, class Compare>
+static bool has_changed(std::optional<T> const& value, std::optional<DeviceState> const& previous, std::optional<T> DeviceState::* member, Compare same)
+{
+    if (!value.has_value()) return false;
+    if (!previous.has_value() || !((*previous).*member).has_value()) return true;
+    return !same(*value, *((*previous).*member));
+}
+
+liberror::Result<libwacom::Area> read_stylus_default_area(libwacom::Device const& device)
+{
+    std::unique_lock lock { the_driver_mutex() };
+
+    auto const current = TRY(the_backend().get_stylus_area(device.id));
+    auto const area = TRY(the_backend().get_stylus_default_area(device.id));
+
+    if (auto const after = TRY(the_backend().get_stylus_area(device.id)); !same_area(after, current))
+    {
+        TRY(the_backend().set_stylus_area(device.id, current));
+    }
+
+    return area;
+}
+
+liberror::Result<void> apply_device_state(libwacom::Device const& device, DeviceState const& state, std::optional<DeviceState> const& previous)
+{
+    std::shared_lock lock { the_driver_mutex() };
+
+    return apply_device_state(the_backend(), device, state, previous);
+}
+
+liberror::Result<void> apply_device_state(Backend const& backend, libwacom::Device const& device, DeviceState const& state, std::optional<DeviceState> const& previous)
+{
+    if (has_changed(state.area, previous, &DeviceState::area, same_area))
+    {
+        TRY(backend.set_stylus_area(device.id, *state.area));
+    }
+
+    if (has_changed(state.pressure, previous, &DeviceState::pressure, same_pressure))
+    {
+        TRY(backend.set_stylus_pressure_curve(device.id, *state.pressure));
+    }
+
+    if (has_changed(state.output, previous, &DeviceState::output, same_area))
+    {
+        TRY(backend.set_stylus_output_from_display_area(device.id, *state.output));
+    }
+
+    return {};
+}
+
+liberror::Result<void> apply_tablet_state(Tablet const& tablet, std::span<DeviceState const> states, std::span<DeviceState const> previous)
+{
+    TraceSpan span { "apply_tablet_state" };
+    span.argument("tablet", tablet.name);
+
+    std::vector<std::future<liberror::Result<void>>> writes {};
+
+    for (size_t i = 0; i < tablet.devices.size() && i < states.size(); i += 1)
+    {
+        auto const before = i < previous.size() ? std::optional(previous[i]) : std::nullopt;
+        writes.push_back(std::async(std::launch::async, [&device = tablet.devices[i], &state = states[i], before] {
+            return apply_device_state(device, state, before);
+        }));
+    }
+
+    // every write is waited on before returning, a failure only stops the device it happened on
+    liberror::Result<void> result {};
+
+    for (size_t i = 0; i < writes.size(); i += 1)
+    {
+        auto written = writes[i].get();
+        if (!written.has_value() && result.has_value())
+            result = liberror::make_error("Failed to apply the settings to \"{}\": {}", tablet.devices[i].name, written.error().message());
+    }
+
+    return trace_result(span, std::move(result));
+}
+
+liberror::Result<void> set_settings_to_tablet(Tablet const& tablet, Monitor const& monitor, DeviceSettings const& settings)
+{
+    return apply_tablet_state(tablet, get_tablet_state(tablet, monitor, settings));
+}
@@ -0,0 +1,320 @@
+#include "Commands.hpp"
+
+#include "Backend.hpp"
+#include "Export.hpp"
+#include "Options.hpp"
+
+#include <liberror/Try.hpp>
+#include <nlohmann/json.hpp>
+#include <fmt/format.h>
+#include <fmt/ranges.h>
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <ranges>
+#include <string>
+
+static nlohmann::ordered_json to_json(libwacom::Area const& area)
+{
+    return { { "offsetX", area.offsetX }, { "offsetY", area.offsetY }, { "width", area.width }, { "height", area.height } };
+}
+
+static nlohmann::ordered_json to_json(libwacom::Pressure const& pressure)
+{
+    return { { "minX", pressure.minX }, { "minY", pressure.minY }, { "maxX", pressure.maxX }, { "maxY", pressure.maxY } };
+}
+
+static nlohmann::ordered_json to_json(Monitor const& monitor)
+{
+    return {
+        { "name", monitor.name },
+        { "primary", monitor.primary },
+        { "area", to_json(libwacom::Area { monitor.offsetX, monitor.offsetY, monitor.width, monitor.height }) },
+    };
+}
+
+static nlohmann::ordered_json to_json(std::vector<DeviceProperty> const& properties)
+{
+    nlohmann::ordered_json json = nlohmann::ordered_json::object();
+    for (auto const& property : properties) json[property.name] = { { "type", property.type }, { "values", property.values } };
+    return json;
+}
+
+// "--device=NAME" picks the stylus, otherwise it is the first one found
+static liberror::Result<libwacom::Device> find_stylus(std::vector<std::string_view> const& arguments)
+{
+    auto const devices = TRY(the_backend().get_available_devices());
+    auto const name = find_option(arguments, "--device");
+
+    auto const device = std::ranges::find_if(devices, [&] (libwacom::Device const& candidate) {
+        return name.has_value() ? candidate.name == *name : candidate.kind == libwacom::Device::Kind::STYLUS;
+    });
+
+    if (device == devices.end())
+    {
+        return name.has_value() ? liberror::make_error("Device \"{}\" could not be found", *name) : liberror::make_error("Failed to load devices");
+    }
+
+    return *device;
+}
+
+// the positional arguments that follow the subcommand
+static std::vector<std::string_view> get_operands(std::vector<std::string_view> const& arguments)
+{
+    std::vector<std::string_view> operands {};
+    std::ranges::copy_if(arguments | std::views::drop(2), std::back_inserter(operands), [] (auto argument) { return !argument.starts_with("--"); });
+    return operands;
+}
+
+static liberror::Result<void> run_get(std::vector<std::string_view> const& arguments)
+{
+    static constexpr std::array PROPERTIES { "area", "default-area", "pressure" };
+
+    auto properties = get_operands(arguments);
+    if (properties.empty()) properties = { "area", "pressure" };
+
+    for (auto property : properties)
+    {
+        if (std::ranges::find(PROPERTIES, property) == PROPERTIES.end())
+            return liberror::make_error("Unknown property \"{}\", expected one of: {}", property, fmt::join(PROPERTIES, ", "));
+    }
+
+    auto const device = TRY(find_stylus(arguments));
+
+    nlohmann::ordered_json json { { "device", device.name } };
+
+    for (auto property : properties)
+    {
+        if (property == "area") json["area"] = to_json(TRY(the_backend().get_stylus_area(device.id)));
+        if (property == "default-area") json["defaultArea"] = to_json(TRY(read_stylus_default_area(device)));
+        if (property == "pressure") json["pressure"] = to_json(TRY(the_backend().get_stylus_pressure_curve(device.id)));
+    }
+
+    fmt::println("{}", json.dump(4));
+
+    return {};
+}
+
+static liberror::Result<void> run_set(std::vector<std::string_view> const& arguments)
+{
+    auto const assignments = get_operands(arguments);
+
+    if (assignments.empty())
+        return liberror::make_error("Nothing to set, expected area=X,Y,W,H or pressure=X1,Y1,X2,Y2");
+
+    // everything is parsed before the first value is applied, so that a typo leaves the device untouched
+    std::optional<libwacom::Area> area {};
+    std::optional<libwacom::Pressure> pressure {};
+
+    for (auto assignment : assignments)
+    {
+        std::array<float, 4> values {};
+
+        if (assignment.starts_with("area="))
+        {
+            TRY(parse_numbers(assignment.substr(5), values));
+            area = libwacom::Area { values[0], values[1], values[2], values[3] };
+        }
+        else if (assignment.starts_with("pressure="))
+        {
+            TRY(parse_numbers(assignment.substr(9), values));
+            if (std::ranges::any_of(values, [] (float value) { return value < 0 || value > 1; }))
+                return liberror::make_error("Pressure curve points must be within [0, 1]: {}", assignment);
+            pressure = libwacom::Pressure { values[0], values[1], values[2], values[3] };
+        }
+        else
+        {
+            return liberror::make_error("Unknown assignment \"{}\", expected area=X,Y,W,H or pressure=X1,Y1,X2,Y2", assignment);
+        }
+    }
+
+    auto const device = TRY(find_stylus(arguments));
+
+    nlohmann::ordered_json json { { "device", device.name } };
+
+    if (area.has_value())
+    {
+        TRY(the_backend().set_stylus_area(device.id, *area));
+        json["area"] = to_json(*area);
+    }
+
+    if (pressure.has_value())
+    {
+        TRY(the_backend().set_stylus_pressure_curve(device.id, *pressure));
+        json["pressure"] = to_json(*pressure);
+    }
+
+    fmt::println("{}", json.dump(4));
+
+    return {};
+}
+
+static liberror::Result<void> run_map_to_monitor(std::vector<std::string_view> const& arguments)
+{
+    auto const operands = get_operands(arguments);
+
+    if (operands.size() != 1)
+        return liberror::make_error("Expected the name of a single monitor");
+
+    auto const monitors = TRY(the_backend().get_available_monitors());
+    auto const monitor = std::ranges::find(monitors, operands.front(), &Monitor::name);
+
+    if (monitor == monitors.end())
+        return liberror::make_error("Monitor \"{}\" could not be found", operands.front());
+
+    auto const device = TRY(find_stylus(arguments));
+
+    TRY(the_backend().set_stylus_output_from_display_area(device.id, { monitor->offsetX, monitor->offsetY, monitor->width, monitor->height }));
+
+    fmt::println("{}", nlohmann::ordered_json { { "device", device.name }, { "monitor", to_json(*monitor) } }.dump(4));
+
+    return {};
+}
+
+static liberror::Result<void> run_dump(std::vector<std::string_view> const& arguments)
+{
+    auto const monitors = TRY(the_backend().get_available_monitors());
+    auto const devices = TRY(the_backend().get_available_devices());
+
+    // every driver property of every device comes from a single read, so asking for them costs next to nothing
+    std::vector<DeviceProperties> properties {};
+    if (find_option(arguments, "--properties").has_value()) properties = TRY(the_backend().get_device_properties());
+
+    nlohmann::ordered_json json { { "devices", nlohmann::ordered_json::array() }, { "monitors", nlohmann::ordered_json::array() } };
+
+    for (auto const& device : devices)
+    {
+        nlohmann::ordered_json entry { { "id", device.id }, { "name", device.name }, { "kind", device.kind.to_string() } };
+
+        if (device.kind == libwacom::Device::Kind::STYLUS)
+        {
+            entry["area"] = to_json(TRY(the_backend().get_stylus_area(device.id)));
+            entry["pressure"] = to_json(TRY(the_backend().get_stylus_pressure_curve(device.id)));
+        }
+
+        if (auto found = std::ranges::find(properties, device.name, &DeviceProperties::deviceName); found != properties.end())
+        {
+            entry["properties"] = to_json(found->properties);
+        }
+
+        json["devices"].push_back(entry);
+    }
+
+    for (auto const& monitor : monitors)
+    {
+        json["monitors"].push_back(to_json(monitor));
+    }
+
+    if (find_option(arguments, "--json").has_value())
+    {
+        fmt::println("{}", json.dump(4));
+        return {};
+    }
+
+    for (auto const& device : json["devices"])
+    {
+        fmt::println("{} ({})", device["name"].get<std::string>(), device["kind"].get<std::string>());
+
+        if (device.contains("area"))
+        {
+            auto const& area = device["area"];
+            auto const& pressure = device["pressure"];
+            fmt::println("    area     {} {} {} {}", area["offsetX"].get<float>(), area["offsetY"].get<float>(), area["width"].get<float>(), area["height"].get<float>());
+            fmt::println("    pressure {} {} {} {}", pressure["minX"].get<float>(), pressure["minY"].get<float>(), pressure["maxX"].get<float>(), pressure["maxY"].get<float>());
+        }
+
+        if (device.contains("properties"))
+        {
+            size_t width = 0;
+            for (auto const& [name, property] : device["properties"].items()) width = std::max(width, name.size());
+
+            for (auto const& [name, property] : device["properties"].items())
+            {
+                fmt::println("    {:<{}} {}", name, width, fmt::join(property["values"].get<std::vector<std::string>>(), ", "));
+            }
+        }
+    }
+
+    for (auto const& monitor : monitors)
+    {
+        fmt::println("{}{} {}x{}+{}+{}", monitor.name, monitor.primary ? " (primary)" : "", monitor.width, monitor.height, monitor.offsetX, monitor.offsetY);
+    }
+
+    return {};
+}
+
+static liberror::Result<void> run_export(std::vector<std::string_view> const& arguments)
+{
+    auto const operands = get_operands(arguments);
+    auto const check = find_option(arguments, "--check").has_value();
+
+    if (!check && (operands.size() != 1 || (operands.front() != "xorg" && operands.front() != "script")))
+        return liberror::make_error("Expected the format to export, either xorg or script");
+
+    DeviceSettings settings {};
+
+    if (!std::filesystem::exists(DEVICE_SETTINGS_FILE) || !load_device_settings(settings))
+        return liberror::make_error("Failed to load device settings");
+
+    // the output mapping is relative to the monitor the settings were made for
+    auto const monitors = TRY(the_backend().get_available_monitors());
+    auto monitor = std::ranges::find(monitors, settings.monitorName, &Monitor::name);
+    if (monitor == monitors.end()) monitor = std::ranges::find_if(monitors, &Monitor::primary);
+    if (monitor == monitors.end())
+        return liberror::make_error("Failed to load monitors");
+
+    if (check)
+    {
+        return check_exports(settings, *monitor, monitors);
+    }
+
+    fmt::print("{}", operands.front() == "xorg" ? export_xorg_snippet(settings, *monitor, monitors) : export_xsetwacom_script(settings, *monitor));
+
+    return {};
+}
+
+using Command = liberror::Result<void>(*)(std::vector<std::string_view> const&);
+
+static std::map<std::string_view, Command> const& get_commands()
+{
+    static std::map<std::string_view, Command> const commands {
+        { "get", run_get },
+        { "set", run_set },
+        { "map-to-monitor", run_map_to_monitor },
+        { "dump", run_dump },
+        { "export", run_export },
+    };
+
+    return commands;
+}
+
+bool is_command(std::vector<std::string_view> const& arguments)
+{
+    return arguments.size() > 1 && get_commands().contains(arguments[1]);
+}
+
+liberror::Result<void> run_command(std::vector<std::string_view> const& arguments)
+{
+    return get_commands().at(arguments[1])(arguments);
+}
+
+void print_commands_help()
+{
+    fmt::println("Commands:");
+    fmt::println("  get [area] [default-area] [pressure]");
+    fmt::println("                        Prints the current values of the stylus as JSON.");
+    fmt::println("  set [area=X,Y,W,H] [pressure=X1,Y1,X2,Y2]");
+    fmt::println("                        Changes the given values of the stylus.");
+    fmt::println("  map-to-monitor NAME   Maps the stylus to the whole of the named monitor.");
+    fmt::println("  dump [--json] [--properties]");
+    fmt::println("                        Lists every device and monitor with their values, along with");
+    fmt::println("                        every property the driver keeps when asked to.");
+    fmt::println("  export xorg|script    Prints the saved settings as an xorg.conf.d snippet or as a");
+    fmt::println("                        shell script of xsetwacom calls.");
+    fmt::println("  export --check        Compares both exports with what would be applied.");
+    fmt::println("");
+    fmt::println("  Every command takes --device=NAME to pick a device other than the first stylus.");
+}
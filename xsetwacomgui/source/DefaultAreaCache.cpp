@@ -0,0 +1,162 @@
+#include "DefaultAreaCache.hpp"
+
+#include "Backend.hpp"
+#include "Trace.hpp"
+
+#include <liberror/Try.hpp>
+#include <nlohmann/json.hpp>
+#include <fmt/format.h>
+
+#include <fstream>
+#include <ranges>
+#include <sstream>
+
+static bool operator==(libwacom::Area const& lhs, libwacom::Area const& rhs)
+{
+    return lhs.offsetX == rhs.offsetX && lhs.offsetY == rhs.offsetY && lhs.width == rhs.width && lhs.height == rhs.height;
+}
+
+DefaultAreaCache::~DefaultAreaCache()
+{
+    // the checks still running touch the cache, so they have to finish before it goes away
+    for (auto& validation : validations) validation.wait();
+}
+
+void DefaultAreaCache::load(std::filesystem::path const& file)
+{
+    TRACE_SCOPE("DefaultAreaCache::load");
+
+    std::lock_guard lock { mutex };
+
+    path = file;
+
+    std::ifstream stream(path);
+    if (!stream.is_open()) return;
+
+    std::stringstream content;
+    content << stream.rdbuf();
+
+    try
+    {
+        for (auto const& [key, area] : nlohmann::json::parse(content.str()).items())
+        {
+            areas[key] = {
+                area["offsetX"].get<float>(),
+                area["offsetY"].get<float>(),
+                area["width"].get<float>(),
+                area["height"].get<float>(),
+            };
+        }
+    }
+    catch (std::exception const&)
+    {
+        // a broken cache is no different from an empty one
+        areas.clear();
+    }
+}
+
+void DefaultAreaCache::save()
+{
+    if (path.empty()) return;
+
+    nlohmann::ordered_json json = nlohmann::ordered_json::object();
+
+    for (auto const& [key, area] : areas)
+    {
+        json[key] = {
+            { "offsetX", area.offsetX },
+            { "offsetY", area.offsetY },
+            { "width", area.width },
+            { "height", area.height },
+        };
+    }
+
+    std::error_code error {};
+    std::filesystem::create_directories(path.parent_path(), error);
+
+    std::ofstream stream(path);
+    stream << json.dump(4);
+}
+
+// the key holds the product id once a worker asked the driver for it. before that, an area cached for a
+// single product under the name of the device is as good as its own, and the check corrects it otherwise.
+std::optional<std::string> DefaultAreaCache::find_key(std::string const& deviceName) const
+{
+    if (auto key = keys.find(deviceName); key != keys.end()) return key->second;
+
+    std::optional<std::string> found {};
+
+    for (auto const& key : areas | std::views::keys)
+    {
+        if (key != deviceName && !key.starts_with(deviceName + ":")) continue;
+        if (found.has_value()) return std::nullopt;
+
+        found = key;
+    }
+
+    return found;
+}
+
+std::string DefaultAreaCache::get_key(libwacom::Device const& device)
+{
+    {
+        std::lock_guard lock { mutex };
+        if (auto key = keys.find(device.name); key != keys.end()) return key->second;
+    }
+
+    // the name alone is ambiguous between models that share it, the product id is added whenever the driver reports it
+    auto const productId = the_backend().get_device_product_id(device.name);
+    auto const key = productId.has_value() ? fmt::format("{}:{:04x}:{:04x}", device.name, productId->vendor, productId->product) : device.name;
+
+    std::lock_guard lock { mutex };
+    keys[device.name] = key;
+
+    return key;
+}
+
+void DefaultAreaCache::validate(libwacom::Device device)
+{
+    auto const key = get_key(device);
+    auto const area = read_stylus_default_area(device);
+
+    std::lock_guard lock { mutex };
+
+    if (!area.has_value())
+    {
+        // a cached area is still good enough to show, without one the failure is all there is to tell
+        if (!areas.contains(key))
+        {
+            failures[device.name] = area.error().message();
+            changes.fetch_add(1, std::memory_order_release);
+        }
+
+        return;
+    }
+
+    if (auto cached = areas.find(key); cached != areas.end() && cached->second == *area) return;
+
+    areas[key] = *area;
+    save();
+    changes.fetch_add(1, std::memory_order_release);
+}
+
+liberror::Result<std::optional<libwacom::Area>> DefaultAreaCache::get(libwacom::Device const& device)
+{
+    std::lock_guard lock { mutex };
+
+    if (auto failure = failures.find(device.name); failure != failures.end())
+        return liberror::make_error("Failed to read the default area of \"{}\": {}", device.name, failure->second);
+
+    // the first time a device is asked for, its area is read on a worker whether it is cached or not
+    if (validated.insert(device.name).second)
+    {
+        validations.push_back(std::async(std::launch::async, &DefaultAreaCache::validate, this, device));
+    }
+
+    if (auto const key = find_key(device.name); key.has_value())
+    {
+        if (auto cached = areas.find(*key); cached != areas.end()) return cached->second;
+    }
+
+    return std::nullopt;
+}
@@ -29,3 +29,13 @@ std::filesystem::path get_application_data_path()
 #endif
 }
 
+std::filesystem::path get_application_cache_path()
+{
+#ifdef DEBUG
+    return std::filesystem::path(HOME) / "build" / "debug" / "cache";
+#else
+    auto cacheHome = getenv("XDG_CACHE_HOME");
+    if (cacheHome) return std::filesystem::path(cacheHome) / NAME;
+    return get_system_home_path() / ".cache" / NAME;
+#endif
+}
@@ -0,0 +1,324 @@
+#include "Export.hpp"
+
+#include "Backend.hpp"
+
+#include <liberror/Try.hpp>
+#include <fmt/format.h>
+#include <fmt/ranges.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <map>
+#include <regex>
+#include <span>
+#include <sstream>
+#include <string_view>
+
+struct ExportedValues
+{
+    libwacom::Area area;       // device units
+    libwacom::Pressure pressure;
+    libwacom::Area output;     // screen pixels
+};
+
+struct ScreenSize
+{
+    float width, height;
+};
+
+// the X screen spans every monitor
+static ScreenSize get_screen_size(std::vector<Monitor> const& monitors)
+{
+    ScreenSize screen { 0, 0 };
+
+    for (auto const& monitor : monitors)
+    {
+        screen.width = std::max(screen.width, monitor.offsetX + monitor.width);
+        screen.height = std::max(screen.height, monitor.offsetY + monitor.height);
+    }
+
+    return screen;
+}
+
+static libwacom::Area get_output_area(DeviceSettings const& settings, Monitor const& monitor)
+{
+    return {
+        settings.monitorArea.offsetX + monitor.offsetX,
+        settings.monitorArea.offsetY + monitor.offsetY,
+        settings.monitorArea.width,
+        settings.monitorArea.height,
+    };
+}
+
+// the driver takes the area as its two corners and the curve as points in [0, 100], both as integers
+static std::array<long, 4> get_area_corners(libwacom::Area const& area)
+{
+    return { std::lround(area.offsetX), std::lround(area.offsetY), std::lround(area.offsetX + area.width), std::lround(area.offsetY + area.height) };
+}
+
+static std::array<long, 4> get_pressure_points(libwacom::Pressure const& pressure)
+{
+    return { std::lround(pressure.minX * 100), std::lround(pressure.minY * 100), std::lround(pressure.maxX * 100), std::lround(pressure.maxY * 100) };
+}
+
+// the wacom driver names its tools after the kernel device they come from, so dropping the tool suffix leaves
+// the name of the pen interface ("Wacom Intuos S Pen"), which the finger and pad interfaces don't contain
+static std::string get_product_name(std::string const& deviceName)
+{
+    static constexpr std::string_view SUFFIX = " stylus";
+
+    if (deviceName.ends_with(SUFFIX)) return deviceName.substr(0, deviceName.size() - SUFFIX.size());
+
+    return deviceName;
+}
+
+std::string export_xorg_snippet(DeviceSettings const& settings, Monitor const& monitor, std::vector<Monitor> const& monitors)
+{
+    auto const screen = get_screen_size(monitors);
+    auto const output = get_output_area(settings, monitor);
+    auto const area = get_area_corners(settings.deviceArea);
+    auto const pressure = get_pressure_points(settings.devicePressure);
+
+    std::array<float, 9> const matrix {
+        output.width / screen.width, 0, output.offsetX / screen.width,
+        0, output.height / screen.height, output.offsetY / screen.height,
+        0, 0, 1,
+    };
+
+    return fmt::format(
+        "# generated by " NAME " for \"{}\" on {}\n"
+        "Section \"InputClass\"\n"
+        "    Identifier \"" NAME " {}\"\n"
+        "    MatchIsTablet \"on\"\n"
+        "    MatchIsTabletPad \"off\"\n"
+        "    MatchIsTouchpad \"off\"\n"
+        "    MatchIsTouchscreen \"off\"\n"
+        "    MatchProduct \"{}\"\n"
+        "    MatchDriver \"wacom\"\n"
+        "    Option \"TopX\" \"{}\"\n"
+        "    Option \"TopY\" \"{}\"\n"
+        "    Option \"BottomX\" \"{}\"\n"
+        "    Option \"BottomY\" \"{}\"\n"
+        "    Option \"PressCurve\" \"{}\"\n"
+        "    # {}x{}+{}+{} on a {}x{} screen\n"
+        "    Option \"TransformationMatrix\" \"{}\"\n"
+        "EndSection\n",
+        settings.deviceName, monitor.name,
+        settings.deviceName,
+        get_product_name(settings.deviceName),
+        area[0], area[1], area[2], area[3],
+        fmt::join(pressure, ","),
+        output.width, output.height, output.offsetX, output.offsetY, screen.width, screen.height,
+        fmt::join(matrix, " ")
+    );
+}
+
+std::string export_xsetwacom_script(DeviceSettings const& settings, Monitor const& monitor)
+{
+    auto const output = get_output_area(settings, monitor);
+
+    return fmt::format(
+        "#!/bin/sh\n"
+        "# generated by " NAME " for \"{}\" on {}\n"
+        "xsetwacom set \"{}\" Area {}\n"
+        "xsetwacom set \"{}\" PressureCurve {}\n"
+        "xsetwacom set \"{}\" MapToOutput {}x{}+{}+{}\n",
+        settings.deviceName, monitor.name,
+        settings.deviceName, fmt::join(get_area_corners(settings.deviceArea), " "),
+        settings.deviceName, fmt::join(get_pressure_points(settings.devicePressure), " "),
+        settings.deviceName, std::lround(output.width), std::lround(output.height), std::lround(output.offsetX), std::lround(output.offsetY)
+    );
+}
+
+static liberror::Result<void> parse_values(std::string const& text, std::string const& pattern, std::span<float> values)
+{
+    std::smatch match;
+
+    if (!std::regex_search(text, match, std::regex(pattern)))
+        return liberror::make_error("Could not find {} in the export", pattern);
+
+    std::istringstream stream(match[1].str());
+    for (auto& value : values)
+    {
+        if (!(stream >> value)) return liberror::make_error("Malformed values in the export: {}", match[1].str());
+    }
+
+    return {};
+}
+
+// the options an InputClass section can hand over to the wacom driver, and the form the driver takes their
+// values in. they are not the names xsetwacom uses, see wacom(4); TransformationMatrix is taken by the X
+// server itself for any input device, see xorg.conf(5).
+struct DriverOption
+{
+    std::string_view name;
+    std::string_view format;
+};
+
+static constexpr std::array DRIVER_OPTIONS {
+    DriverOption { "TopX", R"(-?\d+)" },
+    DriverOption { "TopY", R"(-?\d+)" },
+    DriverOption { "BottomX", R"(-?\d+)" },
+    DriverOption { "BottomY", R"(-?\d+)" },
+    DriverOption { "PressCurve", R"(\d+,\d+,\d+,\d+)" },
+    DriverOption { "TransformationMatrix", R"([-+.\deE]+( [-+.\deE]+){8})" },
+};
+
+// every option of the snippet, which is refused when the driver would not know it or not take its value
+static liberror::Result<std::map<std::string, std::string>> parse_xorg_options(std::string const& snippet)
+{
+    static std::regex const OPTION_PATTERN { R"re(\s*Option\s+"([^"]*)"\s+"([^"]*)"\s*)re" };
+
+    std::map<std::string, std::string> options {};
+    std::istringstream stream(snippet);
+
+    for (std::string line; std::getline(stream, line);)
+    {
+        std::smatch match;
+        if (!std::regex_match(line, match, OPTION_PATTERN)) continue;
+
+        auto const name = match[1].str();
+        auto const value = match[2].str();
+
+        auto const option = std::ranges::find(DRIVER_OPTIONS, name, &DriverOption::name);
+        if (option == DRIVER_OPTIONS.end())
+            return liberror::make_error("The wacom driver has no option \"{}\"", name);
+
+        if (!std::regex_match(value, std::regex(option->format.begin(), option->format.end())))
+            return liberror::make_error("The wacom driver does not take \"{}\" for option \"{}\"", value, name);
+
+        options[name] = value;
+    }
+
+    return options;
+}
+
+static liberror::Result<std::string> get_xorg_option(std::map<std::string, std::string> const& options, std::string const& name)
+{
+    auto const option = options.find(name);
+    if (option == options.end())
+        return liberror::make_error("Could not find option \"{}\" in the export", name);
+
+    return option->second;
+}
+
+static liberror::Result<ExportedValues> parse_xorg_snippet(std::string const& snippet, ScreenSize screen)
+{
+    auto const options = TRY(parse_xorg_options(snippet));
+
+    std::array<float, 4> corners {}, pressure {};
+    std::array<float, 9> matrix {};
+
+    static constexpr std::array CORNERS { "TopX", "TopY", "BottomX", "BottomY" };
+
+    for (size_t i = 0; i < CORNERS.size(); i += 1)
+    {
+        corners[i] = std::stof(TRY(get_xorg_option(options, CORNERS[i])));
+    }
+
+    auto curve = TRY(get_xorg_option(options, "PressCurve"));
+    std::ranges::replace(curve, ',', ' ');
+    TRY(parse_values(curve, "(.*)", pressure));
+    auto const transformation = TRY(get_xorg_option(options, "TransformationMatrix"));
+    TRY(parse_values(transformation, "(.*)", matrix));
+
+    if (std::ranges::any_of(pressure, [] (float point) { return point > 100; }))
+        return liberror::make_error("The wacom driver takes PressCurve points within [0, 100]: {}", curve);
+
+    return ExportedValues {
+        .area = { corners[0], corners[1], corners[2] - corners[0], corners[3] - corners[1] },
+        .pressure = { pressure[0] / 100, pressure[1] / 100, pressure[2] / 100, pressure[3] / 100 },
+        .output = { matrix[2] * screen.width, matrix[5] * screen.height, matrix[0] * screen.width, matrix[4] * screen.height },
+    };
+}
+
+static liberror::Result<ExportedValues> parse_xsetwacom_script(std::string const& script)
+{
+    std::array<float, 4> area {}, pressure {}, output {};
+
+    TRY(parse_values(script, R"(Area ([-\d ]+))", area));
+    TRY(parse_values(script, R"(PressureCurve ([\d ]+))", pressure));
+
+    std::smatch match;
+    if (!std::regex_search(script, match, std::regex(R"(MapToOutput (\d+)x(\d+)\+(-?\d+)\+(-?\d+))")))
+        return liberror::make_error("Could not find MapToOutput in the export");
+    for (size_t i = 0; i < output.size(); i += 1) output[i] = std::stof(match[i + 1].str());
+
+    return ExportedValues {
+        .area = { area[0], area[1], area[2] - area[0], area[3] - area[1] },
+        .pressure = { pressure[0] / 100, pressure[1] / 100, pressure[2] / 100, pressure[3] / 100 },
+        .output = { output[2], output[3], output[0], output[1] },
+    };
+}
+
+// applies the state of the stylus against a backend that only remembers what it was given
+static liberror::Result<ExportedValues> record_applied_values(DeviceSettings const& settings, Monitor const& monitor)
+{
+    ExportedValues applied {};
+
+    // only the setters are ever called, the backend in use is neither touched nor swapped out
+    Backend recording {};
+    recording.set_stylus_area = [&] (Backend::DeviceId, libwacom::Area area) -> liberror::Result<void> { applied.area = area; return {}; };
+    recording.set_stylus_pressure_curve = [&] (Backend::DeviceId, libwacom::Pressure pressure) -> liberror::Result<void> { applied.pressure = pressure; return {}; };
+    recording.set_stylus_output_from_display_area = [&] (Backend::DeviceId, libwacom::Area area) -> liberror::Result<void> { applied.output = area; return {}; };
+
+    auto const result = apply_device_state(recording, libwacom::Device {}, get_device_state(monitor, settings));
+
+    if (!result.has_value()) return std::unexpected(result.error());
+
+    return applied;
+}
+
+static size_t compare_values(char const* source, ExportedValues const& exported, ExportedValues const& applied)
+{
+    // integers are all the driver takes, so anything within rounding is the same value
+    static constexpr float UNIT_TOLERANCE = 0.5f;
+    static constexpr float PRESSURE_TOLERANCE = 0.005f;
+
+    struct Field { char const* name; float exported, applied, tolerance; };
+
+    std::array const fields {
+        Field { "area.offsetX", exported.area.offsetX, applied.area.offsetX, UNIT_TOLERANCE },
+        Field { "area.offsetY", exported.area.offsetY, applied.area.offsetY, UNIT_TOLERANCE },
+        Field { "area.width", exported.area.width, applied.area.width, 2 * UNIT_TOLERANCE },
+        Field { "area.height", exported.area.height, applied.area.height, 2 * UNIT_TOLERANCE },
+        Field { "pressure.minX", exported.pressure.minX, applied.pressure.minX, PRESSURE_TOLERANCE },
+        Field { "pressure.minY", exported.pressure.minY, applied.pressure.minY, PRESSURE_TOLERANCE },
+        Field { "pressure.maxX", exported.pressure.maxX, applied.pressure.maxX, PRESSURE_TOLERANCE },
+        Field { "pressure.maxY", exported.pressure.maxY, applied.pressure.maxY, PRESSURE_TOLERANCE },
+        Field { "output.offsetX", exported.output.offsetX, applied.output.offsetX, UNIT_TOLERANCE },
+        Field { "output.offsetY", exported.output.offsetY, applied.output.offsetY, UNIT_TOLERANCE },
+        Field { "output.width", exported.output.width, applied.output.width, UNIT_TOLERANCE },
+        Field { "output.height", exported.output.height, applied.output.height, UNIT_TOLERANCE },
+    };
+
+    size_t mismatches = 0;
+
+    for (auto const& field : fields)
+    {
+        auto const matches = std::abs(field.exported - field.applied) <= field.tolerance;
+        fmt::println("{:<8} {:<16} {:>12.4f} {:>12.4f} {}", source, field.name, field.exported, field.applied, matches ? "ok" : "MISMATCH");
+        mismatches += matches ? 0 : 1;
+    }
+
+    return mismatches;
+}
+
+liberror::Result<void> check_exports(DeviceSettings const& settings, Monitor const& monitor, std::vector<Monitor> const& monitors)
+{
+    auto const applied = TRY(record_applied_values(settings, monitor));
+    auto const xorg = TRY(parse_xorg_snippet(export_xorg_snippet(settings, monitor, monitors), get_screen_size(monitors)));
+    auto const script = TRY(parse_xsetwacom_script(export_xsetwacom_script(settings, monitor)));
+
+    fmt::println("{:<8} {:<16} {:>12} {:>12}", "export", "value", "exported", "applied");
+
+    auto const mismatches = compare_values("xorg", xorg, applied) + compare_values("script", script, applied);
+
+    if (mismatches != 0)
+    {
+        return liberror::make_error("{} exported values differ from what would be applied", mismatches);
+    }
+
+    return {};
+}
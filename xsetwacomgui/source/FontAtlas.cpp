@@ -0,0 +1,88 @@
+#include "FontAtlas.hpp"
+
+#include "Trace.hpp"
+
+#include <filesystem>
+#include <string>
+
+std::unique_ptr<ImFontAtlas> build_font_atlas(std::string const& font, float scale)
+{
+    static constexpr float FONT_SIZE = 20.f;
+
+    static const ImWchar ranges[] =
+    {
+        0x0020, 0x00FF, // Basic Latin + Latin Supplement
+        0x0400, 0x052F, // Cyrillic + Cyrillic Supplement
+        0x2DE0, 0x2DFF, // Cyrillic Extended-A
+        0xA640, 0xA69F, // Cyrillic Extended-B
+        0,
+    };
+
+    TraceSpan span { "build_font_atlas" };
+    span.argument("font", font);
+    span.argument("scale", std::to_string(scale));
+
+    auto atlas = std::make_unique<ImFontAtlas>();
+
+    if (font == "default" || !std::filesystem::exists(font) || atlas->AddFontFromFileTTF(font.data(), FONT_SIZE * scale, nullptr, ranges) == nullptr)
+    {
+        atlas->AddFontDefault();
+    }
+
+    // building the texture data here is what takes time, the upload left for the render thread is cheap
+    unsigned char* pixels = nullptr;
+    int width = 0, height = 0;
+    atlas->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+    return atlas;
+}
+
+MemoryUsage get_font_atlas_memory_usage(ImFontAtlas const& atlas)
+{
+    auto const pixels = static_cast<size_t>(atlas.TexWidth) * static_cast<size_t>(atlas.TexHeight);
+
+    size_t cpu = 0;
+    if (atlas.TexPixelsAlpha8) cpu += pixels;
+    if (atlas.TexPixelsRGBA32) cpu += pixels * 4;
+    for (auto const* font : atlas.Fonts) cpu += static_cast<size_t>(font->Glyphs.Size) * sizeof(ImFontGlyph);
+
+    return { cpu, pixels * 4 };
+}
+
+void FontAtlasBuilder::start(Request request)
+{
+    pending = std::async(std::launch::async, [request = std::move(request)] {
+        return build_font_atlas(request.font, request.scale);
+    });
+}
+
+void FontAtlasBuilder::request(std::string font, float scale)
+{
+    // a std::async future blocks on destruction, so a running build is never replaced, only followed
+    if (pending.valid())
+    {
+        queued = Request { std::move(font), scale };
+        return;
+    }
+
+    start({ std::move(font), scale });
+}
+
+std::unique_ptr<ImFontAtlas> FontAtlasBuilder::take()
+{
+    if (!pending.valid() || pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+        return nullptr;
+    }
+
+    auto atlas = pending.get();
+
+    if (queued.has_value())
+    {
+        start(std::move(*queued));
+        queued.reset();
+        return nullptr;
+    }
+
+    return atlas;
+}
@@ -0,0 +1,204 @@
+#include "FontPreview.hpp"
+
+#include "Memory.hpp"
+#include "SoftwareRenderer.hpp"
+#include "Trace.hpp"
+
+#include <imgui/imgui_internal.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+std::optional<FontPreviewImage> rasterise_font_preview(std::filesystem::path const& font, std::string const& text, float size)
+{
+    TraceSpan span { "rasterise_font_preview" };
+    span.argument("font", font.string());
+
+    ImFontGlyphRangesBuilder builder;
+    builder.AddText(text.data(), text.data() + text.size());
+    ImVector<ImWchar> ranges;
+    builder.BuildRanges(&ranges);
+
+    // without oversampling a glyph takes as many pixels in the atlas as it does on screen, so it can be copied as is
+    ImFontConfig config;
+    config.SizePixels = size;
+    config.OversampleH = 1;
+    config.OversampleV = 1;
+    config.PixelSnapH = true;
+
+    ImFontAtlas atlas;
+    ImFont* face = nullptr;
+
+    if (font == "default")
+    {
+        face = atlas.AddFontDefault(&config);
+    }
+    else if (std::filesystem::exists(font))
+    {
+        face = atlas.AddFontFromFileTTF(font.c_str(), size, &config, ranges.Data);
+    }
+
+    if (face == nullptr) return std::nullopt;
+
+    unsigned char* alpha = nullptr;
+    int atlasWidth = 0, atlasHeight = 0;
+    atlas.GetTexDataAsAlpha8(&alpha, &atlasWidth, &atlasHeight);
+    if (alpha == nullptr) return std::nullopt;
+
+    auto const width = static_cast<int>(std::ceil(face->CalcTextSizeA(face->FontSize, FLT_MAX, 0.f, text.data(), text.data() + text.size()).x));
+    auto const height = static_cast<int>(std::ceil(face->FontSize));
+    if (width <= 0 || height <= 0) return std::nullopt;
+
+    FontPreviewImage image { width, height, std::vector<uint32_t>(static_cast<size_t>(width) * static_cast<size_t>(height), 0x00FFFFFF) };
+
+    auto penX = 0.f;
+    for (auto cursor = text.data(), end = text.data() + text.size(); cursor < end;)
+    {
+        unsigned int codepoint = 0;
+        cursor += ImTextCharFromUtf8(&codepoint, cursor, end);
+
+        auto const* glyph = face->FindGlyph(static_cast<ImWchar>(codepoint));
+        if (glyph == nullptr) continue;
+
+        auto const sourceX = static_cast<int>(std::lround(glyph->U0 * static_cast<float>(atlasWidth)));
+        auto const sourceY = static_cast<int>(std::lround(glyph->V0 * static_cast<float>(atlasHeight)));
+        auto const glyphWidth = static_cast<int>(std::lround((glyph->U1 - glyph->U0) * static_cast<float>(atlasWidth)));
+        auto const glyphHeight = static_cast<int>(std::lround((glyph->V1 - glyph->V0) * static_cast<float>(atlasHeight)));
+
+        // the glyph offsets are already relative to the top of the line
+        auto const targetX = static_cast<int>(std::lround(penX + glyph->X0));
+        auto const targetY = static_cast<int>(std::lround(glyph->Y0));
+
+        for (auto y = std::max(0, -targetY); y < glyphHeight && targetY + y < height; y += 1)
+        {
+            for (auto x = std::max(0, -targetX); x < glyphWidth && targetX + x < width; x += 1)
+            {
+                auto const coverage = alpha[static_cast<size_t>(sourceY + y) * static_cast<size_t>(atlasWidth) + static_cast<size_t>(sourceX + x)];
+                auto& pixel = image.pixels[static_cast<size_t>(targetY + y) * static_cast<size_t>(width) + static_cast<size_t>(targetX + x)];
+                pixel = std::max(pixel, static_cast<uint32_t>(coverage) << 24 | 0x00FFFFFF);
+            }
+        }
+
+        penX += glyph->AdvanceX;
+    }
+
+    return image;
+}
+
+FontPreviewCache::FontPreviewCache(size_t budgetBytes, float previewSize)
+    : budget(budgetBytes)
+    , size(previewSize)
+    , thread([this] (std::stop_token const& token) { run(token); })
+{
+}
+
+FontPreviewCache::~FontPreviewCache()
+{
+    for (auto const& entry : entries) destroy_texture(entry.preview.texture);
+
+    set_memory_usage("font previews", { 0, 0 });
+}
+
+void FontPreviewCache::run(std::stop_token const& token)
+{
+    while (true)
+    {
+        Request request;
+
+        {
+            std::unique_lock lock { mutex };
+            if (!wake.wait(lock, token, [this] { return !queue.empty(); })) return;
+
+            // the newest request is the row that just scrolled into view
+            request = std::move(queue.back());
+            queue.pop_back();
+        }
+
+        auto image = rasterise_font_preview(request.font, request.text, size);
+
+        std::scoped_lock lock { mutex };
+        rasterised.push_back({ std::move(request.font), std::move(image) });
+    }
+}
+
+void FontPreviewCache::evict()
+{
+    // whatever was drawn last stays, even when it alone is over the budget
+    while (used > budget && entries.size() > 1)
+    {
+        auto const& entry = entries.back();
+        destroy_texture(entry.preview.texture);
+
+        used -= entry.bytes;
+        index.erase(entry.font);
+        entries.pop_back();
+    }
+}
+
+std::optional<FontPreview> FontPreviewCache::get(std::filesystem::path const& font, std::string const& text)
+{
+    auto const& key = font.native();
+
+    if (auto entry = index.find(key); entry != index.end())
+    {
+        entries.splice(entries.begin(), entries, entry->second);
+        return entry->second->preview;
+    }
+
+    if (pending.contains(key) || failed.contains(key)) return std::nullopt;
+
+    std::scoped_lock lock { mutex };
+
+    // rows that scrolled by too fast to be rasterised are forgotten, they are asked for again if they come back
+    if (queue.size() == MAX_QUEUED)
+    {
+        pending.erase(queue.front().font.native());
+        queue.pop_front();
+    }
+
+    queue.push_back({ font, text });
+    pending.insert(key);
+    wake.notify_one();
+
+    return std::nullopt;
+}
+
+void FontPreviewCache::upload()
+{
+    size_t uploads = 0;
+
+    for (; uploads < MAX_UPLOADS_PER_FRAME; uploads += 1)
+    {
+        std::optional<Rasterised> next {};
+
+        {
+            std::scoped_lock lock { mutex };
+            if (rasterised.empty()) break;
+            next = std::move(rasterised.back());
+            rasterised.pop_back();
+        }
+
+        auto key = next->font.native();
+        pending.erase(key);
+
+        if (!next->image.has_value())
+        {
+            failed.insert(std::move(key));
+            continue;
+        }
+
+        auto const& image = *next->image;
+
+        FontPreview const preview { create_texture(image.width, image.height, image.pixels.data()), { static_cast<float>(image.width), static_cast<float>(image.height) } };
+        auto const bytes = image.pixels.size() * sizeof(uint32_t);
+
+        entries.push_front({ key, preview, bytes });
+        index[std::move(key)] = entries.begin();
+        used += bytes;
+
+        evict();
+    }
+
+    if (uploads != 0) set_memory_usage("font previews", { 0, used });
+}
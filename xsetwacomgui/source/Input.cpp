@@ -0,0 +1,627 @@
+#include "Input.hpp"
+
+#include <liberror/Try.hpp>
+#include <fmt/format.h>
+
+#include <X11/Xatom.h>
+#include <X11/Xlib.h>
+#include <X11/Xlib-xcb.h>
+#include <X11/extensions/XInput2.h>
+#include <xcb/xinput.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <span>
+#include <unordered_map>
+#include <poll.h>
+
+enum Axis { AXIS_X, AXIS_Y, AXIS_PRESSURE, AXIS_TILT_X, AXIS_TILT_Y, AXIS_COUNT };
+
+struct Valuator
+{
+    int number = -1;
+    double min = 0, max = 1;
+
+    float normalise(double value) const
+    {
+        return max > min ? static_cast<float>((value - min) / (max - min)) : 0.f;
+    }
+};
+
+struct StylusConnection
+{
+    Display* display = nullptr;
+    int opcode = 0;
+    int deviceId = 0;
+    int masterId = 0; // the master the device moves, or the device itself when it has none
+    std::array<Valuator, AXIS_COUNT> valuators {};
+
+    ~StylusConnection()
+    {
+        if (display) XCloseDisplay(display);
+    }
+};
+
+static liberror::Result<void> find_device(StylusConnection& connection, std::string_view deviceName)
+{
+    static constexpr std::array<char const*, AXIS_COUNT> AXIS_LABELS { "Abs X", "Abs Y", "Abs Pressure", "Abs Tilt X", "Abs Tilt Y" };
+
+    int count = 0;
+    auto devices = XIQueryDevice(connection.display, XIAllDevices, &count);
+    auto device = std::find_if(devices, devices + count, [&] (XIDeviceInfo const& info) { return deviceName == info.name; });
+
+    if (device == devices + count)
+    {
+        XIFreeDeviceInfo(devices);
+        return liberror::make_error("Device \"{}\" could not be found through XInput2", deviceName);
+    }
+
+    connection.deviceId = device->deviceid;
+    connection.masterId = device->use == XISlavePointer ? device->attachment : device->deviceid;
+
+    for (auto const* info : std::span(device->classes, static_cast<size_t>(device->num_classes)))
+    {
+        if (info->type != XIValuatorClass) continue;
+
+        auto const* valuator = reinterpret_cast<XIValuatorClassInfo const*>(info);
+        auto const label = valuator->label ? XGetAtomName(connection.display, valuator->label) : nullptr;
+
+        // the wacom driver labels its axes, but fall back to its fixed axis order when it does not
+        size_t axis = static_cast<size_t>(valuator->number);
+        for (size_t i = 0; label && i < AXIS_LABELS.size(); i += 1)
+        {
+            if (std::strcmp(label, AXIS_LABELS[i]) == 0) axis = i;
+        }
+
+        if (label) XFree(label);
+
+        if (axis < AXIS_COUNT)
+        {
+            connection.valuators[axis] = { valuator->number, valuator->min, valuator->max };
+        }
+    }
+
+    XIFreeDeviceInfo(devices);
+
+    return {};
+}
+
+static liberror::Result<std::unique_ptr<StylusConnection>> open_connection(std::string_view deviceName, std::initializer_list<int> eventTypes)
+{
+    auto connection = std::make_unique<StylusConnection>();
+
+    connection->display = XOpenDisplay(nullptr);
+    if (connection->display == nullptr)
+        return liberror::make_error("Failed to open the X display");
+
+    int event = 0, error = 0;
+    if (!XQueryExtension(connection->display, "XInputExtension", &connection->opcode, &event, &error))
+        return liberror::make_error("The X server does not support XInput");
+
+    int major = 2, minor = 0;
+    if (XIQueryVersion(connection->display, &major, &minor) != Success)
+        return liberror::make_error("The X server does not support XInput2");
+
+    if (auto result = find_device(*connection, deviceName); !result.has_value())
+        return std::unexpected(result.error());
+
+    std::array<unsigned char, XIMaskLen(XI_LASTEVENT)> maskData {};
+    for (auto eventType : eventTypes) XISetMask(maskData.data(), eventType);
+    XIEventMask mask { connection->deviceId, static_cast<int>(maskData.size()), maskData.data() };
+    XISelectEvents(connection->display, DefaultRootWindow(connection->display), &mask, 1);
+    XFlush(connection->display);
+
+    return connection;
+}
+
+// calls the handler with every XInput2 event that arrives until the deadline or until a stop is requested
+template <class Handler>
+static void read_events(StylusConnection& connection, std::stop_token const& token, std::chrono::steady_clock::time_point deadline, Handler&& handler)
+{
+    static constexpr int POLL_TIMEOUT_MS = 100;
+
+    while (!token.stop_requested() && std::chrono::steady_clock::now() < deadline)
+    {
+        pollfd descriptor { ConnectionNumber(connection.display), POLLIN, 0 };
+        if (XPending(connection.display) == 0 && poll(&descriptor, 1, POLL_TIMEOUT_MS) <= 0) continue;
+
+        while (XPending(connection.display) > 0)
+        {
+            XEvent event;
+            XNextEvent(connection.display, &event);
+
+            auto& cookie = event.xcookie;
+            if (cookie.type != GenericEvent || cookie.extension != connection.opcode || !XGetEventData(connection.display, &cookie)) continue;
+
+            handler(cookie.evtype, cookie.data);
+
+            XFreeEventData(connection.display, &cookie);
+        }
+    }
+}
+
+// raw events only carry the axes that changed, so the rest has to be carried over from the previous one
+static void update_axes(StylusConnection const& connection, XIRawEvent const& raw, std::array<double, AXIS_COUNT>& state)
+{
+    for (int number = 0, index = 0; number < raw.valuators.mask_len * 8; number += 1)
+    {
+        if (!XIMaskIsSet(raw.valuators.mask, number)) continue;
+
+        for (size_t axis = 0; axis < AXIS_COUNT; axis += 1)
+        {
+            if (connection.valuators[axis].number == number) state[axis] = raw.raw_values[index];
+        }
+
+        index += 1;
+    }
+}
+
+liberror::Result<std::unique_ptr<StylusInput>> StylusInput::open(std::string_view deviceName)
+{
+    // raw events are delivered to the root window regardless of focus and before the driver applies
+    // the output mapping, which is what an inspector wants to see
+    auto connection = TRY(open_connection(deviceName, { XI_RawMotion }));
+
+    auto input = std::unique_ptr<StylusInput>(new StylusInput());
+    input->thread = std::jthread([input = input.get(), connection = std::move(connection)] (std::stop_token token) {
+        input->run(token, *connection);
+    });
+
+    return input;
+}
+
+void StylusInput::run(std::stop_token const& token, StylusConnection& connection)
+{
+    std::array<double, AXIS_COUNT> state {};
+    for (size_t axis = 0; axis < AXIS_COUNT; axis += 1)
+    {
+        state[axis] = (connection.valuators[axis].min + connection.valuators[axis].max) / 2;
+    }
+
+    read_events(connection, token, std::chrono::steady_clock::time_point::max(), [&] (int type, void const* data) {
+        if (type != XI_RawMotion) return;
+
+        auto const& raw = *static_cast<XIRawEvent const*>(data);
+        update_axes(connection, raw, state);
+
+        auto const& valuators = connection.valuators;
+        StylusEvent event {
+            .time = std::chrono::steady_clock::now(),
+            .serverTime = raw.time,
+            .x = valuators[AXIS_X].normalise(state[AXIS_X]),
+            .y = valuators[AXIS_Y].normalise(state[AXIS_Y]),
+            .pressure = valuators[AXIS_PRESSURE].normalise(state[AXIS_PRESSURE]),
+            .tiltX = valuators[AXIS_TILT_X].normalise(state[AXIS_TILT_X]) * 2 - 1,
+            .tiltY = valuators[AXIS_TILT_Y].normalise(state[AXIS_TILT_Y]) * 2 - 1,
+        };
+
+        if (!events.push(event))
+        {
+            droppedEvents.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+}
+
+liberror::Result<std::unique_ptr<DevicePropertyWatcher>> DevicePropertyWatcher::open(std::string_view deviceName)
+{
+    auto connection = TRY(open_connection(deviceName, { XI_PropertyEvent }));
+
+    auto watcher = std::unique_ptr<DevicePropertyWatcher>(new DevicePropertyWatcher());
+    watcher->thread = std::jthread([watcher = watcher.get(), connection = std::move(connection)] (std::stop_token token) {
+        watcher->run(token, *connection);
+    });
+
+    return watcher;
+}
+
+void DevicePropertyWatcher::run(std::stop_token const& token, StylusConnection& connection)
+{
+    // the driver only creates its properties once the device is there, which it already is by now
+    std::array<std::pair<Atom, Property>, 2> const properties {{
+        { XInternAtom(connection.display, "Wacom Tablet Area", True), AREA },
+        { XInternAtom(connection.display, "Wacom Pressurecurve", True), PRESSURE_CURVE },
+    }};
+
+    read_events(connection, token, std::chrono::steady_clock::time_point::max(), [&] (int type, void const* data) {
+        if (type != XI_PropertyEvent) return;
+
+        auto const& event = *static_cast<XIPropertyEvent const*>(data);
+        if (event.deviceid != connection.deviceId) return;
+
+        for (auto [atom, property] : properties)
+        {
+            if (atom != None && event.property == atom) changed.fetch_or(property, std::memory_order_release);
+        }
+    });
+}
+
+// the server stamps its events with its own millisecond clock. it is matched to ours through the round trip
+// of a property change, whose notification is stamped by the server about halfway through the trip
+static InputCapture::ServerClock sync_server_clock(Display* display)
+{
+    static constexpr int ATTEMPTS = 8;
+
+    auto const window = XCreateSimpleWindow(display, DefaultRootWindow(display), 0, 0, 1, 1, 0, 0, 0);
+    XSelectInput(display, window, PropertyChangeMask);
+    auto const property = XInternAtom(display, "_XSETWACOMGUI_CLOCK", False);
+
+    InputCapture::ServerClock clock { {}, 0, std::chrono::steady_clock::duration::max() };
+
+    // the shortest trip is the one that says the most about when the server stamped it
+    for (int attempt = 0; attempt < ATTEMPTS; attempt += 1)
+    {
+        auto const sent = std::chrono::steady_clock::now();
+        XChangeProperty(display, window, property, XA_INTEGER, 32, PropModeAppend, nullptr, 0);
+
+        XEvent event;
+        XWindowEvent(display, window, PropertyChangeMask, &event);
+
+        auto const roundTrip = std::chrono::steady_clock::now() - sent;
+        if (roundTrip < clock.roundTrip) clock = { sent + roundTrip / 2, event.xproperty.time, roundTrip };
+    }
+
+    XDestroyWindow(display, window);
+
+    // whatever the device sent in the meantime would only come out as late
+    XSync(display, True);
+
+    return clock;
+}
+
+liberror::Result<InputCapture> capture_input(std::string_view deviceName, std::chrono::nanoseconds duration)
+{
+    auto connection = TRY(open_connection(deviceName, { XI_RawMotion }));
+
+    InputCapture capture { .deviceName = std::string(deviceName), .duration = duration };
+    capture.clock = sync_server_clock(connection->display);
+
+    // cooked events are the same reports after the driver applied the area and output mapping. they go to
+    // whichever window is under the pointer, so the pointer is grabbed to get them all for as long as this runs
+    std::array<unsigned char, XIMaskLen(XI_LASTEVENT)> maskData {};
+    XISetMask(maskData.data(), XI_Motion);
+    XIEventMask mask { connection->masterId, static_cast<int>(maskData.size()), maskData.data() };
+
+    auto const root = DefaultRootWindow(connection->display);
+    if (XIGrabDevice(connection->display, connection->masterId, root, CurrentTime, None, XIGrabModeAsync, XIGrabModeAsync, False, &mask) != GrabSuccess)
+        return liberror::make_error("Failed to grab the pointer of \"{}\"", deviceName);
+
+    std::array<double, AXIS_COUNT> state {};
+
+    auto const deadline = std::chrono::steady_clock::now() + duration;
+
+    read_events(*connection, std::stop_token {}, deadline, [&] (int type, void const* data) {
+        auto const now = std::chrono::steady_clock::now();
+
+        if (type == XI_RawMotion)
+        {
+            auto const& raw = *static_cast<XIRawEvent const*>(data);
+            update_axes(*connection, raw, state);
+            capture.raw.push_back({ now, raw.time, state[AXIS_X], state[AXIS_Y] });
+        }
+        else if (type == XI_Motion)
+        {
+            // the master also moves for every other pointer
+            auto const& cooked = *static_cast<XIDeviceEvent const*>(data);
+            if (cooked.sourceid != connection->deviceId) return;
+
+            capture.cooked.push_back({ now, cooked.time, cooked.root_x, cooked.root_y });
+        }
+    });
+
+    XIUngrabDevice(connection->display, connection->masterId, CurrentTime);
+    XFlush(connection->display);
+
+    return capture;
+}
+
+liberror::Result<ProductId> get_device_product_id(std::string_view deviceName)
+{
+    StylusConnection connection {};
+
+    connection.display = XOpenDisplay(nullptr);
+    if (connection.display == nullptr)
+        return liberror::make_error("Failed to open the X display");
+
+    TRY(find_device(connection, deviceName));
+
+    auto const property = XInternAtom(connection.display, "Device Product ID", True);
+    if (property == None)
+        return liberror::make_error("The X server does not report product ids");
+
+    Atom type = None;
+    int format = 0;
+    unsigned long count = 0, remaining = 0;
+    unsigned char* data = nullptr;
+
+    if (XIGetProperty(connection.display, connection.deviceId, property, 0, 2, False, AnyPropertyType, &type, &format, &count, &remaining, &data) != Success)
+        return liberror::make_error("Failed to read the product id of \"{}\"", deviceName);
+
+    // the property holds two 32 bit integers, the vendor and the product id
+    std::array<int32_t, 2> ids {};
+    if (format == 32 && count == ids.size()) std::memcpy(ids.data(), data, sizeof(ids));
+    if (data) XFree(data);
+
+    if (format != 32 || count != ids.size())
+        return liberror::make_error("The product id of \"{}\" is malformed", deviceName);
+
+    return ProductId { static_cast<unsigned>(ids[0]), static_cast<unsigned>(ids[1]) };
+}
+
+// the kernel tells where the input device behind a node is plugged, as in "usb-0000:00:14.0-2/input0". the
+// pen and the touch surface of one tablet are different interfaces of the same usb device, so that part goes
+static std::string get_physical_location(std::string_view deviceNode)
+{
+    std::ifstream stream(std::filesystem::path("/sys/class/input") / std::filesystem::path(deviceNode).filename() / "device" / "phys");
+
+    std::string location {};
+    std::getline(stream, location);
+
+    if (auto const interface = location.rfind("/input"); interface != std::string::npos) location.erase(interface);
+
+    return location;
+}
+
+liberror::Result<std::vector<DeviceLocation>> get_device_locations()
+{
+    static constexpr long MAX_LENGTH = 64; // in 32 bit units, a device node path is far shorter
+
+    StylusConnection connection {};
+
+    connection.display = XOpenDisplay(nullptr);
+    if (connection.display == nullptr)
+        return liberror::make_error("Failed to open the X display");
+
+    int major = 2, minor = 0;
+    if (XIQueryVersion(connection.display, &major, &minor) != Success)
+        return liberror::make_error("The X server does not support XInput2");
+
+    std::vector<DeviceLocation> result {};
+
+    auto const property = XInternAtom(connection.display, "Device Node", True);
+    if (property == None) return result;
+
+    int count = 0;
+    auto devices = XIQueryDevice(connection.display, XIAllDevices, &count);
+
+    for (auto const& device : std::span(devices, static_cast<size_t>(count)))
+    {
+        Atom type = None;
+        int format = 0;
+        unsigned long length = 0, remaining = 0;
+        unsigned char* data = nullptr;
+
+        if (XIGetProperty(connection.display, device.deviceid, property, 0, MAX_LENGTH, False, XA_STRING, &type, &format, &length, &remaining, &data) != Success) continue;
+
+        std::string node {};
+        if (type == XA_STRING && format == 8 && data) node.assign(reinterpret_cast<char const*>(data), length);
+        if (data) XFree(data);
+
+        if (node.empty()) continue;
+
+        if (auto location = get_physical_location(node); !location.empty())
+        {
+            result.push_back({ device.deviceid, std::move(location) });
+        }
+    }
+
+    XIFreeDeviceInfo(devices);
+
+    return result;
+}
+
+// the same few atoms come up on every device, each name is only asked for once
+static std::string const& get_atom_name(Display* display, std::unordered_map<Atom, std::string>& names, Atom atom)
+{
+    if (auto name = names.find(atom); name != names.end()) return name->second;
+
+    auto const text = atom != None ? XGetAtomName(display, atom) : nullptr;
+    auto& name = names[atom] = text ? text : "None";
+    if (text) XFree(text);
+
+    return name;
+}
+
+static int64_t read_integer(unsigned char const* data, int format, bool isSigned)
+{
+    if (format == 8)
+    {
+        int8_t value = 0;
+        std::memcpy(&value, data, sizeof(value));
+        return isSigned ? static_cast<int64_t>(value) : static_cast<int64_t>(static_cast<uint8_t>(value));
+    }
+
+    if (format == 16)
+    {
+        int16_t value = 0;
+        std::memcpy(&value, data, sizeof(value));
+        return isSigned ? static_cast<int64_t>(value) : static_cast<int64_t>(static_cast<uint16_t>(value));
+    }
+
+    int32_t value = 0;
+    std::memcpy(&value, data, sizeof(value));
+    return isSigned ? static_cast<int64_t>(value) : static_cast<int64_t>(static_cast<uint32_t>(value));
+}
+
+// asks for every name that is not known yet at once and only then waits on the replies
+static void fetch_atom_names(xcb_connection_t* connection, std::unordered_map<Atom, std::string>& names, std::span<Atom const> atoms)
+{
+    std::vector<std::pair<Atom, xcb_get_atom_name_cookie_t>> requests {};
+
+    for (auto atom : atoms)
+    {
+        if (atom == None || !names.try_emplace(atom, "None").second) continue;
+        requests.emplace_back(atom, xcb_get_atom_name(connection, static_cast<xcb_atom_t>(atom)));
+    }
+
+    for (auto [atom, cookie] : requests)
+    {
+        auto reply = xcb_get_atom_name_reply(connection, cookie, nullptr);
+        if (reply == nullptr) continue;
+
+        names[atom].assign(xcb_get_atom_name_name(reply), static_cast<size_t>(xcb_get_atom_name_name_length(reply)));
+        std::free(reply);
+    }
+}
+
+static DeviceProperty read_property(Display* display, Atom property, xcb_input_xi_get_property_reply_t const* reply, Atom floatType, std::unordered_map<Atom, std::string>& names)
+{
+    DeviceProperty result { get_atom_name(display, names, property), "None", {} };
+
+    if (reply == nullptr) return result;
+
+    auto const type = static_cast<Atom>(reply->type);
+    auto const format = static_cast<int>(reply->format);
+    auto const count = static_cast<unsigned long>(reply->num_items);
+    auto const* data = static_cast<unsigned char const*>(xcb_input_xi_get_property_items(reply));
+
+    result.type = get_atom_name(display, names, type);
+
+    // unlike window properties, 32 bit items come packed as 32 bits and not as longs
+    auto const size = static_cast<unsigned long>(format / 8);
+
+    if (type == XA_STRING && format == 8)
+    {
+        // several strings are separated by their terminators
+        auto const* text = reinterpret_cast<char const*>(data);
+        for (unsigned long start = 0, end = 0; start < count; start = end + 1)
+        {
+            for (end = start; end < count && text[end] != '\0'; end += 1) {}
+            result.values.emplace_back(text + start, end - start);
+        }
+    }
+    else
+    {
+        for (unsigned long i = 0; i < count && size != 0; i += 1)
+        {
+            auto const* item = data + i * size;
+
+            if (type == XA_ATOM && format == 32)
+            {
+                result.values.push_back(get_atom_name(display, names, static_cast<Atom>(read_integer(item, format, false))));
+            }
+            else if (type == floatType && format == 32)
+            {
+                float value = 0;
+                std::memcpy(&value, item, sizeof(value));
+                result.values.push_back(fmt::format("{}", value));
+            }
+            else
+            {
+                result.values.push_back(fmt::format("{}", read_integer(item, format, type == XA_INTEGER)));
+            }
+        }
+    }
+
+    return result;
+}
+
+liberror::Result<std::vector<DeviceProperties>> get_device_properties()
+{
+    static constexpr uint32_t MAX_LENGTH = 1024; // in 32 bit units, far more than any driver property holds
+
+    StylusConnection connection {};
+
+    connection.display = XOpenDisplay(nullptr);
+    if (connection.display == nullptr)
+        return liberror::make_error("Failed to open the X display");
+
+    int major = 2, minor = 0;
+    if (XIQueryVersion(connection.display, &major, &minor) != Success)
+        return liberror::make_error("The X server does not support XInput2");
+
+    std::vector<DeviceProperties> result {};
+
+    // the driver puts its tool type on every device it creates, without it being loaded there is nothing to read
+    auto const toolType = XInternAtom(connection.display, "Wacom Tool Type", True);
+    if (toolType == None) return result;
+
+    auto const floatType = XInternAtom(connection.display, "FLOAT", True);
+    std::unordered_map<Atom, std::string> names {};
+
+    // every request of a step goes out before the first reply is waited on, so the whole read takes a
+    // few round trips to the server instead of one per property and per atom name
+    auto* xcb = XGetXCBConnection(connection.display);
+
+    int count = 0;
+    auto devices = XIQueryDevice(connection.display, XIAllDevices, &count);
+    auto const infos = std::span(devices, static_cast<size_t>(count));
+
+    std::vector<xcb_input_xi_list_properties_cookie_t> lists {};
+    for (auto const& device : infos)
+    {
+        lists.push_back(xcb_input_xi_list_properties(xcb, static_cast<xcb_input_device_id_t>(device.deviceid)));
+    }
+
+    struct PendingProperty
+    {
+        size_t device;
+        Atom atom;
+        xcb_input_xi_get_property_cookie_t cookie;
+    };
+
+    std::vector<PendingProperty> pending {};
+
+    for (size_t i = 0; i < infos.size(); i += 1)
+    {
+        auto reply = xcb_input_xi_list_properties_reply(xcb, lists[i], nullptr);
+        if (reply == nullptr) continue;
+
+        auto const atoms = std::span(xcb_input_xi_list_properties_properties(reply), static_cast<size_t>(xcb_input_xi_list_properties_properties_length(reply)));
+
+        if (std::ranges::find(atoms, static_cast<xcb_atom_t>(toolType)) != atoms.end())
+        {
+            result.push_back(DeviceProperties { infos[i].name, {} });
+
+            for (auto atom : atoms)
+            {
+                auto const cookie = xcb_input_xi_get_property(xcb, static_cast<xcb_input_device_id_t>(infos[i].deviceid), 0, atom, XCB_ATOM_ANY, 0, MAX_LENGTH);
+                pending.push_back({ result.size() - 1, atom, cookie });
+            }
+        }
+
+        std::free(reply);
+    }
+
+    XIFreeDeviceInfo(devices);
+
+    // the names of the properties, of their types and of the atoms they hold are all asked for together
+    std::vector<xcb_input_xi_get_property_reply_t*> replies {};
+    std::vector<Atom> atoms {};
+
+    for (auto const& property : pending)
+    {
+        auto reply = replies.emplace_back(xcb_input_xi_get_property_reply(xcb, property.cookie, nullptr));
+
+        atoms.push_back(property.atom);
+        if (reply == nullptr) continue;
+
+        atoms.push_back(static_cast<Atom>(reply->type));
+
+        if (reply->type == XA_ATOM && reply->format == 32)
+        {
+            auto const* items = static_cast<unsigned char const*>(xcb_input_xi_get_property_items(reply));
+            for (uint32_t i = 0; i < reply->num_items; i += 1) atoms.push_back(static_cast<Atom>(read_integer(items + i * 4, 32, false)));
+        }
+    }
+
+    fetch_atom_names(xcb, names, atoms);
+
+    for (size_t i = 0; i < pending.size(); i += 1)
+    {
+        result[pending[i].device].properties.push_back(read_property(connection.display, pending[i].atom, replies[i], floatType, names));
+        std::free(replies[i]);
+    }
+
+    for (auto& entry : result)
+    {
+        std::ranges::sort(entry.properties, {}, &DeviceProperty::name);
+    }
+
+    return result;
+}
@@ -0,0 +1,170 @@
+#include "InputMeasurement.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+static double to_microseconds(std::chrono::steady_clock::duration duration)
+{
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+// the server clock counts milliseconds in 32 bits and wraps around after about 49 days
+static double to_microseconds(unsigned long fromServerTime, unsigned long toServerTime)
+{
+    return static_cast<double>(static_cast<int32_t>(static_cast<uint32_t>(toServerTime - fromServerTime))) * 1000.0;
+}
+
+// how long after the server stamped an event it reached us, with the stamp moved onto our clock
+static double to_latency(InputCapture::ServerClock const& clock, unsigned long serverTime, std::chrono::steady_clock::time_point received)
+{
+    return to_microseconds(received - clock.time) - to_microseconds(clock.serverTime, serverTime);
+}
+
+static nlohmann::ordered_json summarise(std::vector<double> values)
+{
+    if (values.empty()) return nullptr;
+
+    std::ranges::sort(values);
+    auto const percentile = [&] (size_t p) { return values.at((values.size() - 1) * p / 100); };
+
+    return {
+        { "mean", std::accumulate(values.begin(), values.end(), 0.0) / static_cast<double>(values.size()) },
+        { "p50", percentile(50) },
+        { "p90", percentile(90) },
+        { "p99", percentile(99) },
+        { "max", values.back() },
+    };
+}
+
+static nlohmann::ordered_json histogram(std::vector<double> const& values)
+{
+    static constexpr std::array BUCKETS_US { 50.0, 100.0, 250.0, 500.0, 1000.0, 2500.0, 5000.0 };
+    std::array<size_t, BUCKETS_US.size() + 1> counts {};
+
+    for (auto value : values)
+    {
+        counts.at(static_cast<size_t>(std::distance(BUCKETS_US.begin(), std::ranges::upper_bound(BUCKETS_US, value)))) += 1;
+    }
+
+    auto json = nlohmann::ordered_json::array();
+    for (size_t i = 0; i < BUCKETS_US.size(); i += 1)
+    {
+        json.push_back({ { "below", BUCKETS_US.at(i) }, { "count", counts.at(i) } });
+    }
+    json.push_back({ { "below", nullptr }, { "count", counts.back() } });
+
+    return json;
+}
+
+nlohmann::ordered_json analyse_input_capture(InputCapture const& capture, std::optional<OutputMapping> const& mapping)
+{
+    auto const seconds = std::chrono::duration<double>(capture.duration).count();
+
+    // the intervals come from the server stamps, when they reached us also depends on how busy this process was
+    std::vector<double> intervals {};
+    for (size_t i = 1; i < capture.raw.size(); i += 1)
+    {
+        intervals.push_back(to_microseconds(capture.raw[i - 1].serverTime, capture.raw[i].serverTime));
+    }
+
+    std::vector<double> rawLatencies {};
+    for (auto const& event : capture.raw)
+    {
+        rawLatencies.push_back(to_latency(capture.clock, event.serverTime, event.time));
+    }
+
+    // an interval much longer than the usual one means the device did report, but the reports never made it here
+    double medianInterval = 0;
+    size_t dropped = 0;
+    auto const outOfOrder = static_cast<size_t>(std::ranges::count_if(intervals, [] (double interval) { return interval < 0; }));
+    std::vector<double> jitter {};
+
+    if (!intervals.empty())
+    {
+        auto sorted = intervals;
+        std::ranges::sort(sorted);
+        medianInterval = sorted.at(sorted.size() / 2);
+
+        for (auto interval : intervals)
+        {
+            jitter.push_back(std::abs(interval - medianInterval));
+            if (medianInterval > 0 && interval > 1.5 * medianInterval) dropped += static_cast<size_t>(std::lround(interval / medianInterval)) - 1;
+        }
+    }
+
+    // the server stamps the raw and the cooked event of one report with the same time, and both streams are
+    // in order, so they can be paired up in a single pass. raw events left without a pair were coalesced.
+    std::vector<double> cookedLatencies {};
+    std::vector<double> mappingErrors {};
+    size_t coalesced = 0, unpairedCooked = 0;
+
+    auto raw = capture.raw.begin();
+    for (auto const& cooked : capture.cooked)
+    {
+        for (; raw != capture.raw.end() && raw->serverTime < cooked.serverTime; raw = std::next(raw)) coalesced += 1;
+
+        if (raw == capture.raw.end() || raw->serverTime != cooked.serverTime)
+        {
+            unpairedCooked += 1;
+            continue;
+        }
+
+        cookedLatencies.push_back(to_latency(capture.clock, cooked.serverTime, cooked.time));
+
+        if (mapping.has_value() && mapping->deviceArea.width > 0 && mapping->deviceArea.height > 0)
+        {
+            auto const& [deviceArea, outputArea] = *mapping;
+            auto const relativeX = std::clamp((raw->x - static_cast<double>(deviceArea.offsetX)) / static_cast<double>(deviceArea.width), 0.0, 1.0);
+            auto const relativeY = std::clamp((raw->y - static_cast<double>(deviceArea.offsetY)) / static_cast<double>(deviceArea.height), 0.0, 1.0);
+            auto const expectedX = static_cast<double>(outputArea.offsetX) + relativeX * static_cast<double>(outputArea.width);
+            auto const expectedY = static_cast<double>(outputArea.offsetY) + relativeY * static_cast<double>(outputArea.height);
+            mappingErrors.push_back(std::hypot(cooked.rootX - expectedX, cooked.rootY - expectedY));
+        }
+
+        raw = std::next(raw);
+    }
+
+    coalesced += static_cast<size_t>(std::distance(raw, capture.raw.end()));
+
+    nlohmann::ordered_json json {
+        { "device", capture.deviceName },
+        { "durationSeconds", seconds },
+        {
+            "raw", {
+                { "events", capture.raw.size() },
+                { "rateHz", seconds > 0 ? static_cast<double>(capture.raw.size()) / seconds : 0.0 },
+                { "medianIntervalUs", medianInterval },
+                { "intervalUs", summarise(intervals) },
+                { "jitterUs", summarise(jitter) },
+                { "jitterHistogramUs", histogram(jitter) },
+                { "dropped", dropped },
+                { "outOfOrder", outOfOrder },
+            }
+        },
+        {
+            "cooked", {
+                { "events", capture.cooked.size() },
+                { "coalesced", coalesced },
+                { "unpaired", unpairedCooked },
+            }
+        },
+        { "clockRoundTripUs", to_microseconds(capture.clock.roundTrip) },
+        {
+            "latencyUs", {
+                { "raw", summarise(rawLatencies) },
+                { "cooked", summarise(cookedLatencies) },
+            }
+        },
+    };
+
+    if (mapping.has_value())
+    {
+        json["mappingErrorPx"] = summarise(mappingErrors);
+    }
+
+    return json;
+}
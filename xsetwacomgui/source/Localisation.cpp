@@ -1,38 +1,47 @@
 #include "Localisation.hpp"
 
-#include "Environment.hpp"
+#include "Memory.hpp"
+#include "Resources.hpp"
 
+#include <liberror/Try.hpp>
 #include <fmt/format.h>
 #include <fplus/fplus.hpp>
 #include <nlohmann/json.hpp>
 
-#include <sstream>
-#include <fstream>
+static void report_memory_usage(auto const& tables)
+{
+    size_t bytes = 0;
+
+    for (auto const& table : tables)
+    {
+        for (auto const& [id, message] : table.second) bytes += sizeof(id) + message.capacity();
+    }
+
+    set_memory_usage("localisation", { bytes, 0 });
+}
 
 liberror::Result<char const*> Localisation::get(ApplicationSettings::Language language, LocalisedMessage id)
 {
     if (!the().contains(language))
     {
         auto languageLowercase = std::string_view(language.to_string()) | std::views::transform(tolower);
-        std::ifstream stream(
-            get_application_data_path() / "languages" / fmt::format("{}.json", std::string(languageLowercase.begin(), languageLowercase.end()))
-        );
-        std::stringstream content;
-        content << stream.rdbuf();
+        auto content = TRY(get_resource(fmt::format("languages/{}.json", std::string(languageLowercase.begin(), languageLowercase.end()))));
 
         try
         {
-            auto json = nlohmann::json::parse(content.str());
+            auto json = nlohmann::json::parse(content.begin(), content.end());
             the()[language] = {
                 { Localisation::Toast_Success, json["toastSuccess"].get<std::string>() },
                 { Localisation::Toast_Warning, json["toastWarning"].get<std::string>() },
                 { Localisation::Toast_Error, json["toastError"].get<std::string>() },
                 { Localisation::Save, json["save"].get<std::string>() },
                 { Localisation::Save_Apply, json["saveApply"].get<std::string>() },
+                { Localisation::Save_Device_Differs, json["saveDeviceDiffers"].get<std::string>() },
                 { Localisation::MenuBar_Settings, json["menuBarSettings"].get<std::string>() },
                 { Localisation::MenuBar_Settings_Application, json["menuBarSettingsApplication"].get<std::string>() },
                 { Localisation::MenuBar_Other, json["menuBarOther"].get<std::string>() },
                 { Localisation::MenuBar_Other_Goddess, json["menuBarOtherGoddess"].get<std::string>() },
+                { Localisation::MenuBar_Other_Memory, json["menuBarOtherMemory"].get<std::string>() },
                 { Localisation::Popup_Settings_Tabs_Appearance_Title, json["popupSettingsTabsAppearanceTitle"].get<std::string>() },
                 { Localisation::Popup_Settings_Tabs_Appearance_Theme, json["popupSettingsTabsAppearanceTheme"].get<std::string>() },
                 { Localisation::Popup_Settings_Tabs_Appearance_Theme_Dark, json["popupSettingsTabsAppearanceThemeDark"].get<std::string>() },
@@ -41,10 +50,27 @@ liberror::Result<char const*> Localisation::get(ApplicationSettings::Language la
                 { Localisation::Popup_Settings_Tabs_Display_Scale, json["popupSettingsTabsDisplayScale"].get<std::string>() },
                 { Localisation::Popup_Settings_Tabs_Language_Title, json["popupSettingsTabsLanguageTitle"].get<std::string>() },
                 { Localisation::Popup_Settings_Tabs_Language_Language, json["popupSettingsTabsLanguageLanguage"].get<std::string>() },
+                { Localisation::Popup_Memory_Resident, json["popupMemoryResident"].get<std::string>() },
+                { Localisation::Popup_Memory_Allocations, json["popupMemoryAllocations"].get<std::string>() },
+                { Localisation::Popup_Memory_Subsystem, json["popupMemorySubsystem"].get<std::string>() },
+                { Localisation::Popup_Memory_Cpu, json["popupMemoryCpu"].get<std::string>() },
+                { Localisation::Popup_Memory_Gpu, json["popupMemoryGpu"].get<std::string>() },
                 { Localisation::Popup_Settings_Tabs_Appearance_Font, json["popupSettingsTabsAppearanceFont"].get<std::string>() },
                 { Localisation::Tabs_Tablet_Title, json["tabsTabletTitle"].get<std::string>() },
                 { Localisation::Tabs_Tablet_Device, json["tabsTabletDevice"].get<std::string>() },
                 { Localisation::Tabs_Tablet_PressureCurve, json["tabsTabletPressureCurve"].get<std::string>() },
+                { Localisation::Tabs_Tablet_Strokes, json["tabsTabletStrokes"].get<std::string>() },
+                { Localisation::Tabs_Tablet_Strokes_None, json["tabsTabletStrokesNone"].get<std::string>() },
+                { Localisation::Tabs_Tablet_Strokes_Record, json["tabsTabletStrokesRecord"].get<std::string>() },
+                { Localisation::Tabs_Tablet_Strokes_Stop, json["tabsTabletStrokesStop"].get<std::string>() },
+                { Localisation::Tabs_Tablet_Strokes_Evaluated, json["tabsTabletStrokesEvaluated"].get<std::string>() },
+                { Localisation::Tabs_Tablet_Calibrate, json["tabsTabletCalibrate"].get<std::string>() },
+                { Localisation::Tabs_Tablet_Calibration_Light, json["tabsTabletCalibrationLight"].get<std::string>() },
+                { Localisation::Tabs_Tablet_Calibration_Medium, json["tabsTabletCalibrationMedium"].get<std::string>() },
+                { Localisation::Tabs_Tablet_Calibration_Firm, json["tabsTabletCalibrationFirm"].get<std::string>() },
+                { Localisation::Tabs_Tablet_Calibration_Samples, json["tabsTabletCalibrationSamples"].get<std::string>() },
+                { Localisation::Tabs_Tablet_Calibration_Next, json["tabsTabletCalibrationNext"].get<std::string>() },
+                { Localisation::Tabs_Tablet_Calibration_Cancel, json["tabsTabletCalibrationCancel"].get<std::string>() },
                 { Localisation::Tabs_Tablet_Width, json["tabsTabletWidth"].get<std::string>() },
                 { Localisation::Tabs_Tablet_Height, json["tabsTabletHeight"].get<std::string>() },
                 { Localisation::Tabs_Tablet_OffsetX, json["tabsTabletOffsetX"].get<std::string>() },
@@ -59,18 +85,49 @@ liberror::Result<char const*> Localisation::get(ApplicationSettings::Language la
                 { Localisation::Tabs_Monitor_OffsetY, json["tabsMonitorOffsetY"].get<std::string>() },
                 { Localisation::Tabs_Monitor_FullArea, json["tabsMonitorFullArea"].get<std::string>() },
                 { Localisation::Tabs_Monitor_ForceProportions, json["tabsMonitorForceProportions"].get<std::string>() },
+                { Localisation::Tabs_Input_Title, json["tabsInputTitle"].get<std::string>() },
+                { Localisation::Tabs_Input_Unavailable, json["tabsInputUnavailable"].get<std::string>() },
+                { Localisation::Tabs_Input_Rate, json["tabsInputRate"].get<std::string>() },
+                { Localisation::Tabs_Input_Dropped, json["tabsInputDropped"].get<std::string>() },
+                { Localisation::Tabs_Input_Position, json["tabsInputPosition"].get<std::string>() },
+                { Localisation::Tabs_Input_Pressure, json["tabsInputPressure"].get<std::string>() },
+                { Localisation::Tabs_Input_Tilt, json["tabsInputTilt"].get<std::string>() },
+                { Localisation::Tabs_Input_Raw, json["tabsInputRaw"].get<std::string>() },
+                { Localisation::Tabs_Input_Curve, json["tabsInputCurve"].get<std::string>() },
+                { Localisation::Tabs_Driver_Title, json["tabsDriverTitle"].get<std::string>() },
+                { Localisation::Tabs_Driver_Refresh, json["tabsDriverRefresh"].get<std::string>() },
+                { Localisation::Tabs_Driver_Search, json["tabsDriverSearch"].get<std::string>() },
+                { Localisation::Tabs_Driver_Read, json["tabsDriverRead"].get<std::string>() },
+                { Localisation::Tabs_Driver_Reading, json["tabsDriverReading"].get<std::string>() },
+                { Localisation::Tabs_Driver_Device, json["tabsDriverDevice"].get<std::string>() },
+                { Localisation::Tabs_Driver_Property, json["tabsDriverProperty"].get<std::string>() },
+                { Localisation::Tabs_Driver_Type, json["tabsDriverType"].get<std::string>() },
+                { Localisation::Tabs_Driver_Value, json["tabsDriverValue"].get<std::string>() },
                 { Localisation::Toast_Devices_Missing, json["toastDevicesMissing"].get<std::string>() },
                 { Localisation::Toast_Application_Settings_Saved, json["toastApplicationSettingsSaved"].get<std::string>() },
                 { Localisation::Toast_Device_Settings_Saved, json["toastDeviceSettingsSaved"].get<std::string>() },
                 { Localisation::Toast_Device_Settings_Load_Failed, json["toastDeviceSettingsLoadFailed"].get<std::string>() },
                 { Localisation::Toast_Device_Settings_Missing, json["toastDeviceSettingsMissing"].get<std::string>() },
+                { Localisation::Toast_Pressure_Curve_Fitted, json["toastPressureCurveFitted"].get<std::string>() },
+                { Localisation::Toast_Pressure_Curve_Fit_Failed, json["toastPressureCurveFitFailed"].get<std::string>() },
             };
         }
         catch (std::exception const& error)
         {
             return liberror::make_error("{}", error.what());
         }
+
+        report_memory_usage(the());
     }
 
     return the()[language][id].data();
 }
+
+void Localisation::release_unused(ApplicationSettings::Language language)
+{
+    if (the().size() == 1 && the().contains(language)) return;
+
+    std::erase_if(the(), [&] (auto const& table) { return table.first != language; });
+
+    report_memory_usage(the());
+}
@@ -2,12 +2,36 @@
 
 #include <spdlog/spdlog.h>
 
+#include "Backend.hpp"
+#include "Commands.hpp"
+#include "DefaultAreaCache.hpp"
 #include "Environment.hpp"
+#include "FontAtlas.hpp"
+#include "FontPreview.hpp"
+#include "Input.hpp"
+#include "InputMeasurement.hpp"
 #include "Localisation.hpp"
+#include "MapperModel.hpp"
+#include "Memory.hpp"
 #include "Monitor.hpp"
+#include "Options.hpp"
+#include "Pressure.hpp"
+#include "PressureFit.hpp"
+#include "Process.hpp"
+#include "Profiles.hpp"
+#include "Profiling.hpp"
+#include "Recording.hpp"
+#include "Resources.hpp"
 #include "Scaling.hpp"
+#include "Scenarios.hpp"
+#include "Seats.hpp"
 #include "Settings.hpp"
+#include "SoftwareRenderer.hpp"
+#include "Strokes.hpp"
+#include "Theme.hpp"
+#include "Trace.hpp"
 #include "Widgets.hpp"
+#include "WindowFocus.hpp"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "external/stb_image/stb_image.h"
@@ -24,11 +48,24 @@
 #include <fplus/fplus.hpp>
 
 #include <filesystem>
+#include <fstream>
+#include <functional>
+#include <future>
 #include <cstdlib>
 #include <span>
 #include <ranges>
 #include <algorithm>
 #include <array>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <numbers>
+#include <optional>
+#include <thread>
+#include <utility>
+
+#include <csignal>
+#include <unistd.h>
 
 std::vector<std::pair<std::string, std::filesystem::path>> get_available_fonts()
 {
@@ -56,32 +93,138 @@ std::vector<std::pair<std::string, std::filesystem::path>> get_available_fonts()
     return fonts;
 }
 
+// scanning the font directories is slow and the list can be long, so it only exists while the settings are open
+struct FontList
+{
+    static constexpr size_t PREVIEW_BUDGET = 4 * 1024 * 1024;
+
+    std::vector<std::pair<std::string, std::filesystem::path>> fonts;
+    int index;
+    std::future<std::vector<std::pair<std::string, std::filesystem::path>>> scan;
+    std::unique_ptr<FontPreviewCache> previews;
+};
+
+std::optional<FontList>& the_font_list()
+{
+    static std::optional<FontList> fontList {};
+    return fontList;
+}
+
+FontList& load_font_list(std::string const& selectedFont)
+{
+    auto& fontList = the_font_list();
+
+    // the directories are walked on a worker, until then the list only has the default and the selected font
+    if (!fontList.has_value())
+    {
+        std::vector<std::pair<std::string, std::filesystem::path>> fonts { { "default", "default" } };
+        if (selectedFont != "default") fonts.push_back({ std::filesystem::path(selectedFont).filename(), selectedFont });
+
+        fontList = FontList { std::move(fonts), static_cast<int>(selectedFont != "default"), std::async(std::launch::async, get_available_fonts), nullptr };
+
+        // a headless run has no renderer to upload the previews to
+        if (ImGui::GetIO().BackendRendererName != nullptr)
+        {
+            fontList->previews = std::make_unique<FontPreviewCache>(FontList::PREVIEW_BUDGET, ImGui::GetFontSize());
+        }
+    }
+
+    if (fontList->scan.valid() && fontList->scan.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+    {
+        auto& fonts = fontList->fonts = fontList->scan.get();
+        fontList->index = static_cast<int>(
+            std::distance(fonts.begin(), std::ranges::find(fonts, std::filesystem::path(selectedFont), &std::pair<std::string, std::filesystem::path>::second))
+        );
+        if (static_cast<size_t>(fontList->index) == fonts.size()) fontList->index = 0;
+
+        size_t bytes = 0;
+        for (auto const& [name, path] : fonts) bytes += sizeof(name) + name.capacity() + sizeof(path) + path.native().capacity();
+        set_memory_usage("font list", { bytes, 0 });
+    }
+
+    return *fontList;
+}
+
+// closing the settings while the directories are still being walked waits for the walk to finish
+void release_font_list()
+{
+    auto& fontList = the_font_list();
+    if (!fontList.has_value()) return;
+
+    fontList.reset();
+    set_memory_usage("font list", { 0, 0 });
+}
+
 liberror::Result<void> render_settings_popup_appearance_tab(ApplicationSettings& settings)
 {
     ImGui::Text("%s", TRY(Localisation::get(settings.language, Localisation::Popup_Settings_Tabs_Appearance_Theme)));
-    char const* themes[] = {
-        TRY(Localisation::get(settings.language, Localisation::Popup_Settings_Tabs_Appearance_Theme_Dark)),
-        TRY(Localisation::get(settings.language, Localisation::Popup_Settings_Tabs_Appearance_Theme_Light))
-    };
-    static int themeIndex = static_cast<int>(settings.theme);
-    auto hasChangedUITheme = ImGui::Combo("##Theme", &themeIndex, themes, std::size(themes));
+    // the built in themes are translated, the ones loaded from disk are shown by their name
+    // the list is only rebuilt when the language changes, so that an open popup doesn't allocate every frame
+    auto const& availableThemes = get_available_themes();
+    static std::optional<ApplicationSettings::Language> themesLanguage {};
+    static std::vector<char const*> themes {};
+    if (themesLanguage != settings.language)
+    {
+        themes = {
+            TRY(Localisation::get(settings.language, Localisation::Popup_Settings_Tabs_Appearance_Theme_Dark)),
+            TRY(Localisation::get(settings.language, Localisation::Popup_Settings_Tabs_Appearance_Theme_Light))
+        };
+        for (auto const& theme : availableThemes | std::views::drop(2)) themes.push_back(theme.data());
+        themesLanguage = settings.language;
+    }
+    static int themeIndex = static_cast<int>(std::distance(availableThemes.begin(), std::ranges::find(availableThemes, settings.theme)));
+    auto hasChangedUITheme = ImGui::Combo("##Theme", &themeIndex, themes.data(), static_cast<int>(themes.size()));
 
     if (hasChangedUITheme)
     {
-        settings.theme = ApplicationSettings::Theme::from_int(themeIndex);
+        settings.theme = availableThemes.at(static_cast<size_t>(themeIndex));
     }
 
     ImGui::Text("%s", TRY(Localisation::get(settings.language, Localisation::Popup_Settings_Tabs_Appearance_Font)));
-    static auto fonts = get_available_fonts();
-    static auto fontsData = fplus::transform([] (auto const& font) { return font.first.data(); }, fonts );
-    static auto fontIndex = static_cast<int>(
-        std::distance(fonts.begin(), std::ranges::find(fonts, std::filesystem::path(settings.font), &decltype(fonts)::value_type::second))
-    );
-    auto hasChangedUIFont = ImGui::Combo("##Font", &fontIndex, fontsData.data(), static_cast<int>(fontsData.size()));
+    auto& fontList = load_font_list(settings.font);
+    if (fontList.previews) fontList.previews->upload();
+
+    auto hasChangedUIFont = false;
+    if (ImGui::BeginCombo("##Font", fontList.fonts.at(static_cast<size_t>(fontList.index)).first.data(), ImGuiComboFlags_HeightLarge))
+    {
+        // only the rows in view are submitted, which are the only ones whose previews get rasterised
+        auto const rowHeight = ImGui::GetFontSize();
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(fontList.fonts.size()));
+
+        while (clipper.Step())
+        {
+            for (auto row = clipper.DisplayStart; row < clipper.DisplayEnd; row += 1)
+            {
+                auto const& [name, path] = fontList.fonts[static_cast<size_t>(row)];
+                auto const isSelected = row == fontList.index;
+                auto const preview = fontList.previews ? fontList.previews->get(path, name) : std::nullopt;
+
+                // until its preview is ready a row shows its name in the current font
+                ImGui::PushID(row);
+                if (ImGui::Selectable(preview.has_value() ? "" : name.data(), isSelected, 0, { 0, rowHeight }))
+                {
+                    fontList.index = row;
+                    hasChangedUIFont = true;
+                }
+
+                if (preview.has_value())
+                {
+                    auto const position = ImGui::GetItemRectMin() + ImVec2 { 0, (rowHeight - preview->size.y) / 2 };
+                    ImGui::GetWindowDrawList()->AddImage(preview->texture, position, position + preview->size, { 0, 0 }, { 1, 1 }, ImGui::GetColorU32(ImGuiCol_Text));
+                }
+
+                if (isSelected) ImGui::SetItemDefaultFocus();
+                ImGui::PopID();
+            }
+        }
+
+        ImGui::EndCombo();
+    }
 
     if (hasChangedUIFont)
     {
-        settings.font = fonts.at(static_cast<size_t>(fontIndex)).second;
+        settings.font = fontList.fonts.at(static_cast<size_t>(fontList.index)).second;
     }
 
     return {};
@@ -165,34 +308,169 @@ liberror::Result<void> render_settings_popup(ApplicationSettings& settings)
     return {};
 }
 
-void render_goddess_popup()
+// the image is only decoded and kept on the gpu while its popup is open
+struct GoddessImage
+{
+    ImTextureID texture = 0;
+    int width = 0, height = 0;
+};
+
+void load_goddess_image(GoddessImage& goddess)
+{
+    // a headless run has no renderer to upload to
+    if (ImGui::GetIO().BackendRendererName == nullptr) return;
+
+    auto const resource = get_resource("images/jahy.png");
+    if (!resource.has_value()) return;
+
+    auto channels = 0;
+    auto image = stbi_load_from_memory(resource->data(), static_cast<int>(resource->size()), &goddess.width, &goddess.height, &channels, STBI_rgb_alpha);
+    if (image == nullptr) return;
+
+    goddess.texture = create_texture(goddess.width, goddess.height, reinterpret_cast<uint32_t const*>(image));
+    stbi_image_free(image);
+
+    set_memory_usage("goddess", { 0, static_cast<size_t>(goddess.width) * static_cast<size_t>(goddess.height) * 4 });
+}
+
+void release_goddess_image(GoddessImage& goddess)
+{
+    if (goddess.texture == 0) return;
+
+    destroy_texture(goddess.texture);
+    goddess = {};
+
+    set_memory_usage("goddess", { 0, 0 });
+}
+
+void render_goddess_popup(GoddessImage& goddess)
+{
+    if (goddess.texture == 0) load_goddess_image(goddess);
+
+    ImVec2 const frameDimensions { static_cast<float>(goddess.width) * 70/100, static_cast<float>(goddess.height) * 70/100 };
+    ImGui::SetCursorPos({ (ImGui::GetWindowWidth() - frameDimensions.x) / 2, (ImGui::GetWindowHeight() - frameDimensions.y) / 2 });
+    ImGui::Image(goddess.texture, frameDimensions);
+}
+
+// measured by the main loop, it stays at zero unless operator new is being counted
+static size_t lastFrameHeapAllocations = 0;
+
+liberror::Result<void> render_memory_popup(ApplicationSettings const& settings)
 {
-    static auto width = 0, height = 0;
-    static auto channels = 0;
-    static auto image = stbi_load((get_application_data_path() / "images/jahy.png").c_str(), &width, &height, &channels, STBI_rgb_alpha);
-    static GLuint imageTexture;
+    auto const report = TRY(get_memory_report());
+    auto const kib = [] (size_t bytes) { return static_cast<double>(bytes) / 1024.0; };
 
-    if (image != nullptr)
+    ImGui::Text("%s: %.1f KiB", TRY(Localisation::get(settings.language, Localisation::Popup_Memory_Resident)), kib(report.residentBytes));
+
+    if constexpr (COUNTING_HEAP_ALLOCATIONS)
     {
-        glGenTextures(1, &imageTexture);
-        glBindTexture(GL_TEXTURE_2D, imageTexture);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-        stbi_image_free(image);
-        image = nullptr;
+        ImGui::Text("%s: %zu", TRY(Localisation::get(settings.language, Localisation::Popup_Memory_Allocations)), lastFrameHeapAllocations);
     }
 
-    static ImVec2 frameDimensions { static_cast<float>(width) * 70/100, static_cast<float>(height) * 70/100 };
-    ImGui::SetCursorPos({ (ImGui::GetWindowWidth() - frameDimensions.x) / 2, (ImGui::GetWindowHeight() - frameDimensions.y) / 2 });
-    ImGui::Image(imageTexture, frameDimensions);
+    if (ImGui::BeginTable("##Memory", 3))
+    {
+        ImGui::TableSetupColumn(TRY(Localisation::get(settings.language, Localisation::Popup_Memory_Subsystem)));
+        ImGui::TableSetupColumn(TRY(Localisation::get(settings.language, Localisation::Popup_Memory_Cpu)));
+        ImGui::TableSetupColumn(TRY(Localisation::get(settings.language, Localisation::Popup_Memory_Gpu)));
+        ImGui::TableHeadersRow();
+
+        for (auto const& [subsystem, usage] : report.subsystems)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", subsystem.data());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f KiB", kib(usage.cpu));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f KiB", kib(usage.gpu));
+        }
+
+        ImGui::EndTable();
+    }
+
+    return {};
 }
 
+struct StylusInspector
+{
+    static constexpr size_t HISTORY_SIZE = 256;
+
+    std::unique_ptr<StylusInput> input;
+    std::optional<StylusEvent> lastEvent;
+
+    std::array<float, HISTORY_SIZE> rawPressure {};
+    std::array<float, HISTORY_SIZE> curvePressure {};
+    size_t historyOffset = 0;
+
+    libwacom::Pressure curve { -1, -1, -1, -1 };
+    std::vector<float> curveTable {};
+
+    size_t eventCount = 0;
+    std::chrono::steady_clock::time_point eventCountStart {};
+    float eventRate = 0;
+
+    std::optional<Stroke> recording {};
+    std::chrono::steady_clock::time_point recordingStart {};
+};
+
+// replays a recorded stroke through the curve being edited
+struct StrokeSimulator
+{
+    std::vector<std::filesystem::path> strokes {};
+    std::vector<std::string> strokeNames {};
+    std::vector<char const*> strokeNamesData {};
+    int strokeIndex = 0;
+
+    std::optional<Stroke> stroke {};
+    std::vector<float> output {};
+    bool outdated = true;
+
+    libwacom::Pressure curve { -1, -1, -1, -1 };
+    std::vector<float> curveTable {};
+
+    float evaluationTime = 0; // microseconds
+};
+
+// walks through drawing the strokes that a curve is then fitted to, one target at a time
+struct PressureCalibration
+{
+    bool active = false;
+    size_t step = 0;
+    std::array<Stroke, CALIBRATION_TARGETS.size()> strokes {};
+};
+
+// every property the driver keeps for every device, read off the render thread and kept until refreshed
+struct DriverInspector
+{
+    struct Row
+    {
+        std::string device, property, type, value;
+    };
+
+    std::future<liberror::Result<std::vector<DeviceProperties>>> read {};
+    std::chrono::steady_clock::time_point readStart {};
+
+    bool hasRead = false;
+    std::vector<Row> rows {};
+    std::optional<std::string> error {};
+    std::chrono::steady_clock::time_point readTime {};
+    float readDuration = 0; // milliseconds
+
+    ImGuiTextFilter filter {};
+};
+
+// what was read from the driver for a device on a worker
+struct DeviceStateReading
+{
+    Backend::DeviceId deviceId;
+    DeviceState state;
+};
+
 struct Context
 {
     libwacom::Device device;
     libwacom::Area deviceDefaultArea;
+    std::vector<Tablet> tablets;
 
     Monitor monitor;
     libwacom::Area monitorDefaultArea;
@@ -202,220 +480,688 @@ struct Context
     bool hasChangedDevicePressure = false;
     bool hasChangedMonitor = false;
     bool hasChangedMonitorArea = false;
+
+    // the default area is read on a worker, until then it is left empty and the mappers show the whole device
+    std::optional<size_t> deviceDefaultAreaGeneration {};
+    bool hasPendingDeviceDefaultArea = false;
+
+    MapperModel monitorMapper {};
+    MapperModel deviceMapper {};
+    MapperConnection mapperConnection {};
+
+    StylusInspector stylus {};
+    StrokeSimulator simulator {};
+    PressureCalibration calibration {};
+    DriverInspector driver {};
+
+    // what the driver holds for the device, which anything else may change at any time
+    std::unique_ptr<DevicePropertyWatcher> deviceProperties {};
+    DeviceState deviceState {};
+    bool hasReadDeviceState = false;
+    std::future<DeviceStateReading> deviceStateRead {};
+    uint32_t deviceStateUnread = 0; // what changed while a read was running
+    std::optional<DeviceSettings> savedSettings {};
 };
 
-liberror::Result<void> set_settings_to_device(libwacom::Device const& device, Monitor const& monitor, DeviceSettings const& settings)
+void open_stylus_inspector(StylusInspector& inspector, libwacom::Device const& device)
 {
-    TRY(libwacom::set_stylus_area(device.id, settings.deviceArea));
-    TRY(libwacom::set_stylus_pressure_curve(device.id, settings.devicePressure));
-    TRY(libwacom::set_stylus_output_from_display_area(device.id, {
-        settings.monitorArea.offsetX + monitor.offsetX,
-        settings.monitorArea.offsetY + monitor.offsetY,
-        settings.monitorArea.width,
-        settings.monitorArea.height,
-    }));
-    return {};
+    inspector = {};
+
+    if (auto input = the_backend().open_stylus_input(device.name); input.has_value())
+    {
+        inspector.input = std::move(input.value());
+        inspector.eventCountStart = std::chrono::steady_clock::now();
+    }
+
+    set_memory_usage("stylus input", { inspector.input ? sizeof(StylusInput) : 0, 0 });
 }
 
-liberror::Result<void> render_region_mappers(Context& context, DeviceSettings& deviceSettings, std::vector<libwacom::Device> const& devices, std::vector<Monitor> const& monitors, ApplicationSettings const& applicationSettings)
+void update_stylus_inspector(StylusInspector& inspector, libwacom::Pressure const& curve)
 {
-    auto [cursorX, cursorY] = ImGui::GetCursorPos();
-    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    if (!inspector.input) return;
 
-    static ImVec2 monitorAreaAnchors[4] { { -1, -1 }, { -1, -1 }, { -1, -1 }, { -1, -1 } };
-
-    if (!monitors.empty())
+    if (inspector.curve.minX != curve.minX || inspector.curve.minY != curve.minY || inspector.curve.maxX != curve.maxX || inspector.curve.maxY != curve.maxY)
     {
-        monitorAreaAnchors[0] = { deviceSettings.monitorArea.offsetX / context.monitorDefaultArea.width, deviceSettings.monitorArea.offsetY / context.monitorDefaultArea.height };
-        monitorAreaAnchors[1] = { deviceSettings.monitorArea.offsetX / context.monitorDefaultArea.width, (deviceSettings.monitorArea.height + deviceSettings.monitorArea.offsetY) / context.monitorDefaultArea.height };
-        monitorAreaAnchors[2] = { (deviceSettings.monitorArea.width + deviceSettings.monitorArea.offsetX) / context.monitorDefaultArea.width, deviceSettings.monitorArea.offsetY / context.monitorDefaultArea.height };
-        monitorAreaAnchors[3] = { (deviceSettings.monitorArea.width + deviceSettings.monitorArea.offsetX) / context.monitorDefaultArea.width, (deviceSettings.monitorArea.height + deviceSettings.monitorArea.offsetY) / context.monitorDefaultArea.height };
+        inspector.curve = curve;
+        inspector.curveTable = make_pressure_curve_table(curve);
     }
-    else
+
+    StylusEvent event;
+    while (inspector.input->pop(event))
     {
-        monitorAreaAnchors[0] = { 0, 0 };
-        monitorAreaAnchors[1] = { 0, 1 };
-        monitorAreaAnchors[2] = { 1, 0 };
-        monitorAreaAnchors[3] = { 1, 1 };
+        inspector.rawPressure[inspector.historyOffset] = event.pressure;
+        inspector.curvePressure[inspector.historyOffset] = evaluate_pressure_curve(inspector.curveTable, event.pressure);
+        inspector.historyOffset = (inspector.historyOffset + 1) % StylusInspector::HISTORY_SIZE;
+        inspector.lastEvent = event;
+        inspector.eventCount += 1;
+
+        if (inspector.recording.has_value())
+        {
+            if (inspector.recording->size() == 0) inspector.recordingStart = event.time;
+            inspector.recording->push(std::chrono::duration<float>(event.time - inspector.recordingStart).count(), event.x, event.y, event.pressure);
+        }
     }
 
-    static const ImVec2 monitorMapperSize { 20 * 16_scaled, 20 * 9_scaled };
-    ImGui::SetCursorPosX((ImGui::GetWindowWidth() - monitorMapperSize.x)/2);
-    static ImRect monitorMapperPosition {};
-    context.hasChangedMonitorArea |= area_mapper(TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Monitor_Monitor)), monitorAreaAnchors, monitorMapperSize, &monitorMapperPosition, deviceSettings.monitorForceFullArea, deviceSettings.monitorForceAspectRatio);
-    ImGui::SetCursorPosX(cursorX);
+    auto const now = std::chrono::steady_clock::now();
+    auto const elapsed = std::chrono::duration<float>(now - inspector.eventCountStart).count();
 
-    if (context.hasChangedMonitorArea)
+    if (elapsed >= 1.f)
     {
-        deviceSettings.monitorArea = {
-            .offsetX = monitorAreaAnchors[0].x * context.monitorDefaultArea.width,
-            .offsetY = monitorAreaAnchors[0].y * context.monitorDefaultArea.height,
-            .width   = (monitorAreaAnchors[2].x - monitorAreaAnchors[0].x) * context.monitorDefaultArea.width,
-            .height  = (monitorAreaAnchors[3].y - monitorAreaAnchors[2].y) * context.monitorDefaultArea.height
-        };
+        inspector.eventRate = static_cast<float>(inspector.eventCount) / elapsed;
+        inspector.eventCount = 0;
+        inspector.eventCountStart = now;
     }
+}
 
-    if (context.hasChangedMonitorArea && deviceSettings.monitorForceFullArea)
-    {
-        deviceSettings.monitorArea = context.monitorDefaultArea;
-    }
+void refresh_driver_inspector(DriverInspector& inspector)
+{
+    if (inspector.read.valid()) return;
 
-    static ImVec2 deviceAreaAnchors[4] { { -1, -1 }, { -1, -1 }, { -1, -1 }, { -1, -1 } };
+    inspector.readStart = std::chrono::steady_clock::now();
+    inspector.read = std::async(std::launch::async, [] { return the_backend().get_device_properties(); });
+}
 
-    if (!devices.empty())
-    {
-        deviceAreaAnchors[0] = { deviceSettings.deviceArea.offsetX / context.deviceDefaultArea.width, deviceSettings.deviceArea.offsetY / context.deviceDefaultArea.height };
-        deviceAreaAnchors[1] = { deviceSettings.deviceArea.offsetX / context.deviceDefaultArea.width, (deviceSettings.deviceArea.height + deviceSettings.deviceArea.offsetY) / context.deviceDefaultArea.height };
-        deviceAreaAnchors[2] = { (deviceSettings.deviceArea.width + deviceSettings.deviceArea.offsetX) / context.deviceDefaultArea.width, deviceSettings.deviceArea.offsetY / context.deviceDefaultArea.height };
-        deviceAreaAnchors[3] = { (deviceSettings.deviceArea.width + deviceSettings.deviceArea.offsetX) / context.deviceDefaultArea.width, (deviceSettings.deviceArea.height + deviceSettings.deviceArea.offsetY) / context.deviceDefaultArea.height };
-    }
-    else
-    {
-        deviceAreaAnchors[0] = { 0, 0 };
-        deviceAreaAnchors[1] = { 0, 1 };
-        deviceAreaAnchors[2] = { 1, 0 };
-        deviceAreaAnchors[3] = { 1, 1 };
-    }
+void update_driver_inspector(DriverInspector& inspector)
+{
+    if (!inspector.read.valid() || inspector.read.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return;
 
-    static const ImVec2 deviceMapperSize { 15 * 16_scaled, 15 * 9_scaled };
-    ImGui::SetCursorPosX((ImGui::GetWindowWidth() - deviceMapperSize.x)/2);
-    static ImRect deviceMapperPosition {};
-    context.hasChangedDeviceArea |= area_mapper(TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Tablet_Device)), deviceAreaAnchors, deviceMapperSize, &deviceMapperPosition, deviceSettings.deviceForceFullArea, deviceSettings.deviceForceAspectRatio);
-    ImGui::SetCursorPosX(cursorX);
+    auto result = inspector.read.get();
 
-    if (context.hasChangedDeviceArea)
-    {
-        deviceSettings.deviceArea = {
-            .offsetX = deviceAreaAnchors[0].x * context.deviceDefaultArea.width,
-            .offsetY = deviceAreaAnchors[0].y * context.deviceDefaultArea.height,
-            .width   = (deviceAreaAnchors[2].x - deviceAreaAnchors[0].x) * context.deviceDefaultArea.width,
-            .height  = (deviceAreaAnchors[3].y - deviceAreaAnchors[2].y) * context.deviceDefaultArea.height
-        };
-    }
+    inspector.hasRead = true;
+    inspector.readTime = std::chrono::steady_clock::now();
+    inspector.readDuration = std::chrono::duration<float, std::milli>(inspector.readTime - inspector.readStart).count();
+    inspector.rows.clear();
+    inspector.error.reset();
 
-    if (context.hasChangedDeviceArea && deviceSettings.deviceForceFullArea)
+    if (!result.has_value())
     {
-        deviceSettings.deviceArea = context.deviceDefaultArea;
+        inspector.error = result.error().message();
+        return;
     }
 
-    for (auto [monitorAnchor, deviceAnchor] : fplus::zip(std::span<ImVec2>(monitorAreaAnchors, 4), std::span<ImVec2>(deviceAreaAnchors, 4)))
+    // the values are joined once here rather than on every frame the table is drawn
+    for (auto const& device : *result)
     {
-        auto p1 = monitorAnchor * (monitorMapperPosition.Max - monitorMapperPosition.Min) + monitorMapperPosition.Min;
-        auto p2 = deviceAnchor * (deviceMapperPosition.Max - deviceMapperPosition.Min) + deviceMapperPosition.Min;
-        drawList->AddLine(p1, p2, ImColor(255, 0, 0, 127), 2.f);
+        for (auto const& property : device.properties)
+        {
+            inspector.rows.push_back({ device.deviceName, property.name, property.type, fplus::join(std::string(", "), property.values) });
+        }
     }
-
-    return {};
 }
 
-liberror::Result<void> render_tablet_settings_tab(Context& context, DeviceSettings& deviceSettings, std::vector<libwacom::Device> const& devices, ApplicationSettings const& applicationSettings)
+// every read is an xsetwacom process, which takes far longer than a frame
+static std::future<DeviceStateReading> read_device_state(libwacom::Device const& device, uint32_t properties)
 {
-    ImGui::SetCursorPosX((ImGui::GetWindowWidth() - (250_scaled + 300_scaled + ImGui::GetStyle().WindowPadding.x))/2);
+    return std::async(std::launch::async, [id = device.id, properties] {
+        // reading the default area resets the area for a moment, what is read here must come before or after that
+        std::shared_lock lock { the_driver_mutex() };
 
-    ImGui::BeginGroup();
-    {
-        ImGui::AlignTextToFramePadding();
-        ImGui::Text("%s", TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Tablet_Device)));
-        auto deviceNames = fplus::transform([] (libwacom::Device const& device) { return device.name.data(); }, devices);
-        ImGui::SetNextItemWidth(300_scaled + ImGui::GetStyle().WindowPadding.x);
-        static int deviceIndex;
-        context.hasChangedDevice = ImGui::Combo("##Device", &deviceIndex, deviceNames.data(), static_cast<int>(deviceNames.size()));
+        DeviceStateReading reading { id, {} };
 
-        if (context.hasChangedDevice)
+        if (properties & DevicePropertyWatcher::AREA)
         {
-            context.device = devices.at(static_cast<size_t>(deviceIndex));
-            context.deviceDefaultArea = TRY(libwacom::get_stylus_default_area(context.device.id));
-            deviceSettings.deviceArea = context.deviceDefaultArea;
+            if (auto area = the_backend().get_stylus_area(id); area.has_value()) reading.state.area = *area;
         }
 
+        if (properties & DevicePropertyWatcher::PRESSURE_CURVE)
         {
-            ImGui::BeginGroup();
-            {
-                ImGui::AlignTextToFramePadding();
-                ImGui::Text("%s", TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Tablet_Width)));
-                ImGui::SetNextItemWidth(150_scaled);
-                context.hasChangedDeviceArea |= ImGui::InputFloat("##TabletWidth", &deviceSettings.deviceArea.width, 0.f, 0.f, "%.0f");
-            }
-            ImGui::EndGroup();
-            ImGui::SameLine();
-            ImGui::BeginGroup();
-            {
-                ImGui::AlignTextToFramePadding();
-                ImGui::Text("%s", TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Tablet_Height)));
-                ImGui::SetNextItemWidth(150_scaled);
-                context.hasChangedDeviceArea |= ImGui::InputFloat("##TabletHeight", &deviceSettings.deviceArea.height, 0.f, 0.f, "%.0f");
-            }
-            ImGui::EndGroup();
-        }
-        {
-            ImGui::BeginGroup();
-            {
-                ImGui::AlignTextToFramePadding();
-                ImGui::Text("%s", TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Tablet_OffsetX)));
-                ImGui::SetNextItemWidth(150_scaled);
-                context.hasChangedDeviceArea |= ImGui::InputFloat("##TabletOffsetX", &deviceSettings.deviceArea.offsetX, 0.f, 0.f, "%.0f");
-            }
-            ImGui::EndGroup();
-            ImGui::SameLine();
-            ImGui::BeginGroup();
-            {
-                ImGui::AlignTextToFramePadding();
-                ImGui::Text("%s", TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Tablet_OffsetY)));
-                ImGui::SetNextItemWidth(150_scaled);
-                context.hasChangedDeviceArea |= ImGui::InputFloat("##TabletOffsetY", &deviceSettings.deviceArea.offsetY, 0.f, 0.f, "%.0f");
-            }
-            ImGui::EndGroup();
+            if (auto pressure = the_backend().get_stylus_pressure_curve(id); pressure.has_value()) reading.state.pressure = *pressure;
         }
 
-        context.hasChangedDeviceArea |= ImGui::Checkbox(TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Tablet_FullArea)), &deviceSettings.deviceForceFullArea);
-        ImGui::BeginDisabled();
-        ImGui::Checkbox(TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Tablet_ForceProportions)), &deviceSettings.deviceForceAspectRatio);
-        ImGui::EndDisabled();
-    }
-    ImGui::EndGroup();
-    ImGui::SameLine();
-    ImGui::BeginGroup();
+        return reading;
+    });
+}
+
+void open_device_properties(Context& context)
+{
+    context.deviceProperties.reset();
+    context.deviceState = {};
+    context.hasReadDeviceState = false;
+    context.deviceStateUnread = 0;
+
+    auto watcher = the_backend().watch_device_properties(context.device.name);
+    if (!watcher.has_value()) return;
+
+    // read once up front, afterwards only what changes is read again. a read still running for the
+    // previous device is left to finish and dropped.
+    context.deviceProperties = std::move(watcher.value());
+    context.deviceStateUnread = DevicePropertyWatcher::AREA | DevicePropertyWatcher::PRESSURE_CURVE;
+}
+
+// the driver keeps whole units and whole percents, so anything within that is the same value
+static bool is_same_area(libwacom::Area const& lhs, libwacom::Area const& rhs)
+{
+    static constexpr float UNIT_TOLERANCE = 1.f;
+
+    return std::abs(lhs.offsetX - rhs.offsetX) <= UNIT_TOLERANCE && std::abs(lhs.offsetY - rhs.offsetY) <= UNIT_TOLERANCE
+        && std::abs(lhs.width - rhs.width) <= UNIT_TOLERANCE && std::abs(lhs.height - rhs.height) <= UNIT_TOLERANCE;
+}
+
+static bool is_same_pressure(libwacom::Pressure const& lhs, libwacom::Pressure const& rhs)
+{
+    static constexpr float PRESSURE_TOLERANCE = 0.01f;
+
+    return std::abs(lhs.minX - rhs.minX) <= PRESSURE_TOLERANCE && std::abs(lhs.minY - rhs.minY) <= PRESSURE_TOLERANCE
+        && std::abs(lhs.maxX - rhs.maxX) <= PRESSURE_TOLERANCE && std::abs(lhs.maxY - rhs.maxY) <= PRESSURE_TOLERANCE;
+}
+
+// the driver now holds the value read. when that is what it already held, as it is when our own writes
+// come back, nothing changed. otherwise the widgets follow it, unless they hold an edit not applied yet.
+template <class Value, class Same>
+static void follow_device_property(std::optional<Value>& held, Value& edited, Value const& read, Same same)
+{
+    if (held.has_value() && same(*held, read)) return;
+
+    if (!held.has_value() || same(edited, *held)) edited = read;
+    held = read;
+}
+
+// a change made from outside, by a script or by xsetwacom itself, is shown in the widgets so that they
+// show what the device does
+void update_device_properties(Context& context, DeviceSettings& deviceSettings)
+{
+    if (!context.deviceProperties) return;
+
+    context.deviceStateUnread |= context.deviceProperties->take();
+
+    if (context.deviceStateRead.valid())
     {
-        static float devicePressureAnchors[4] = {};
+        if (context.deviceStateRead.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return;
 
-        if (!devices.empty())
+        auto const reading = context.deviceStateRead.get();
+
+        if (reading.deviceId == context.device.id && !context.hasReadDeviceState)
         {
-            devicePressureAnchors[0] = deviceSettings.devicePressure.minX;
-            devicePressureAnchors[1] = deviceSettings.devicePressure.minY;
-            devicePressureAnchors[2] = deviceSettings.devicePressure.maxX;
-            devicePressureAnchors[3] = deviceSettings.devicePressure.maxY;
+            context.deviceState = reading.state;
+            context.hasReadDeviceState = true;
         }
-        else
+        else if (reading.deviceId == context.device.id)
         {
-            devicePressureAnchors[0] = 0;
-            devicePressureAnchors[1] = 0;
-            devicePressureAnchors[2] = 1;
-            devicePressureAnchors[3] = 1;
+            if (reading.state.area) follow_device_property(context.deviceState.area, deviceSettings.deviceArea, *reading.state.area, is_same_area);
+            if (reading.state.pressure) follow_device_property(context.deviceState.pressure, deviceSettings.devicePressure, *reading.state.pressure, is_same_pressure);
         }
+    }
 
-        ImGui::AlignTextToFramePadding();
-        context.hasChangedDevicePressure = ImGui::BezierEditor(TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Tablet_PressureCurve)), devicePressureAnchors, { 250_scaled, 250_scaled });
-
-        if (context.hasChangedDevicePressure)
-        {
-            deviceSettings.devicePressure = { devicePressureAnchors[0], devicePressureAnchors[1], devicePressureAnchors[2], devicePressureAnchors[3] };
-        }
+    if (context.deviceStateUnread != 0)
+    {
+        context.deviceStateRead = read_device_state(context.device, std::exchange(context.deviceStateUnread, 0));
     }
-    ImGui::EndGroup();
+}
 
-    return {};
+bool differs_from_saved_settings(Context const& context)
+{
+    if (!context.savedSettings.has_value()) return false;
+
+    auto const& saved = *context.savedSettings;
+    auto const& area = context.deviceState.area;
+    auto const& pressure = context.deviceState.pressure;
+
+    return (area && !is_same_area(*area, saved.deviceArea)) || (pressure && !is_same_pressure(*pressure, saved.devicePressure));
 }
 
-liberror::Result<void> render_monitor_settings_tab(Context& context, DeviceSettings& deviceSettings, std::vector<Monitor> const& monitors, ApplicationSettings const& applicationSettings)
+struct LayoutMetrics
 {
-    ImGui::SetCursorPosX((ImGui::GetWindowWidth() - (300_scaled + ImGui::GetStyle().WindowPadding.x))/2);
+    ImVec2 monitorMapperSize;
+    ImVec2 deviceMapperSize;
+};
 
-    ImGui::BeginGroup();
+LayoutMetrics const& get_layout_metrics()
+{
+    static LayoutMetrics metrics {};
+    static auto generation = the_scale_generation() - 1;
+
+    if (generation != the_scale_generation())
     {
-        ImGui::AlignTextToFramePadding();
+        generation = the_scale_generation();
+        metrics = {
+            .monitorMapperSize = { 20 * 16_scaled, 20 * 9_scaled },
+            .deviceMapperSize = { 15 * 16_scaled, 15 * 9_scaled },
+        };
+    }
+
+    return metrics;
+}
+
+liberror::Result<void> render_region_mappers(Context& context, DeviceSettings& deviceSettings, ApplicationSettings const& applicationSettings)
+{
+    auto [cursorX, cursorY] = ImGui::GetCursorPos();
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+
+    auto& monitorMapper = context.monitorMapper;
+    auto& deviceMapper = context.deviceMapper;
+
+    // the settings may have been changed by anything since the last frame, both models only catch up when they were
+    sync_mapper_model(monitorMapper, deviceSettings.monitorArea, context.monitorDefaultArea);
+    sync_mapper_model(deviceMapper, deviceSettings.deviceArea, context.deviceDefaultArea);
+
+    ImRect frame {};
+
+    auto const& monitorMapperSize = get_layout_metrics().monitorMapperSize;
+    ImGui::SetCursorPosX((ImGui::GetWindowWidth() - monitorMapperSize.x)/2);
+    auto const hasDraggedMonitorArea = area_mapper(TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Monitor_Monitor)), monitorMapper.anchors, monitorMapperSize, &frame, deviceSettings.monitorForceFullArea, deviceSettings.monitorForceAspectRatio);
+    set_mapper_frame(monitorMapper, frame);
+    ImGui::SetCursorPosX(cursorX);
+
+    if (hasDraggedMonitorArea)
+    {
+        deviceSettings.monitorArea = commit_mapper_model(monitorMapper);
+    }
+
+    context.hasChangedMonitorArea |= hasDraggedMonitorArea;
+
+    if (context.hasChangedMonitorArea && deviceSettings.monitorForceFullArea)
+    {
+        deviceSettings.monitorArea = context.monitorDefaultArea;
+    }
+
+    auto const& deviceMapperSize = get_layout_metrics().deviceMapperSize;
+    ImGui::SetCursorPosX((ImGui::GetWindowWidth() - deviceMapperSize.x)/2);
+    auto const hasDraggedDeviceArea = area_mapper(TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Tablet_Device)), deviceMapper.anchors, deviceMapperSize, &frame, deviceSettings.deviceForceFullArea, deviceSettings.deviceForceAspectRatio);
+    set_mapper_frame(deviceMapper, frame);
+    ImGui::SetCursorPosX(cursorX);
+
+    if (hasDraggedDeviceArea)
+    {
+        deviceSettings.deviceArea = commit_mapper_model(deviceMapper);
+    }
+
+    context.hasChangedDeviceArea |= hasDraggedDeviceArea;
+
+    if (context.hasChangedDeviceArea && deviceSettings.deviceForceFullArea && context.deviceDefaultArea.width > 0)
+    {
+        deviceSettings.deviceArea = context.deviceDefaultArea;
+    }
+
+    update_mapper_connection(context.mapperConnection, monitorMapper, deviceMapper);
+    for (auto const& [from, to] : context.mapperConnection.lines)
+    {
+        drawList->AddLine(from, to, ImColor(255, 0, 0, 127), 2.f);
+    }
+
+    if (context.stylus.lastEvent.has_value())
+    {
+        static auto constexpr PEN_RADIUS = 4.f;
+        auto const penColor = ImGui::GetColorU32(ImGuiCol_PlotHistogram);
+
+        ImVec2 const penAnchor { context.stylus.lastEvent->x, context.stylus.lastEvent->y };
+        drawList->AddCircleFilled(to_mapper_pixels(deviceMapper, penAnchor), PEN_RADIUS, penColor);
+
+        // the pen only reaches the monitor while it is inside the mapped area, which the driver scales linearly
+        auto const& deviceAnchors = deviceMapper.anchors;
+        auto const& monitorAnchors = monitorMapper.anchors;
+        auto const deviceAreaSize = deviceAnchors[3] - deviceAnchors[0];
+        if (deviceAreaSize.x > 0 && deviceAreaSize.y > 0)
+        {
+            auto const penRelative = (penAnchor - deviceAnchors[0]) / deviceAreaSize;
+            if (penRelative.x >= 0 && penRelative.x <= 1 && penRelative.y >= 0 && penRelative.y <= 1)
+            {
+                auto const monitorAnchor = monitorAnchors[0] + penRelative * (monitorAnchors[3] - monitorAnchors[0]);
+                drawList->AddCircleFilled(to_mapper_pixels(monitorMapper, monitorAnchor), PEN_RADIUS, penColor);
+            }
+        }
+    }
+
+    return {};
+}
+
+// the selected stroke is kept if it is still there, otherwise the first one is loaded
+void load_saved_strokes(StrokeSimulator& simulator, std::filesystem::path const& selected = {})
+{
+    simulator.strokes = get_saved_strokes();
+    simulator.strokeNames = fplus::transform([] (std::filesystem::path const& path) { return path.stem().string(); }, simulator.strokes);
+    simulator.strokeNamesData = fplus::transform([] (std::string const& name) { return name.data(); }, simulator.strokeNames);
+    auto const found = std::ranges::find(simulator.strokes, selected);
+    simulator.strokeIndex = found == simulator.strokes.end() ? 0 : static_cast<int>(found - simulator.strokes.begin());
+    simulator.stroke.reset();
+    simulator.outdated = true;
+
+    if (!simulator.strokes.empty())
+    {
+        auto stroke = load_stroke(simulator.strokes.at(static_cast<size_t>(simulator.strokeIndex)));
+        if (stroke.has_value())
+            simulator.stroke = std::move(stroke.value());
+        else
+            spdlog::warn("{}", stroke.error().message());
+    }
+
+    auto const samples = simulator.stroke.has_value() ? simulator.stroke->size() : 0;
+    simulator.output.resize(samples);
+    set_memory_usage("stroke simulator", { samples * sizeof(float) * 5, 0 });
+}
+
+void update_stroke_simulator(StrokeSimulator& simulator, libwacom::Pressure const& curve)
+{
+    if (simulator.curve.minX != curve.minX || simulator.curve.minY != curve.minY || simulator.curve.maxX != curve.maxX || simulator.curve.maxY != curve.maxY)
+    {
+        simulator.curve = curve;
+        simulator.curveTable = make_pressure_curve_table(curve);
+        simulator.outdated = true;
+    }
+
+    if (!simulator.outdated || !simulator.stroke.has_value()) return;
+
+    auto const start = std::chrono::steady_clock::now();
+    evaluate_pressure_curve(simulator.curveTable, simulator.stroke->pressure, simulator.output);
+    simulator.evaluationTime = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+    simulator.outdated = false;
+}
+
+liberror::Result<void> render_stroke_simulator(Context& context, libwacom::Pressure const& curve, ApplicationSettings const& applicationSettings)
+{
+    auto& simulator = context.simulator;
+    auto& inspector = context.stylus;
+
+    ImGui::AlignTextToFramePadding();
+    ImGui::Text("%s", TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Tablet_Strokes)));
+    ImGui::SameLine();
+
+    auto const buttonWidth = 100_scaled;
+    ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x - buttonWidth - ImGui::GetStyle().ItemSpacing.x);
+    if (simulator.strokes.empty())
+    {
+        ImGui::BeginDisabled();
+        auto const* none = TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Tablet_Strokes_None));
+        int noneIndex = 0;
+        ImGui::Combo("##Strokes", &noneIndex, &none, 1);
+        ImGui::EndDisabled();
+    }
+    else if (ImGui::Combo("##Strokes", &simulator.strokeIndex, simulator.strokeNamesData.data(), static_cast<int>(simulator.strokeNamesData.size())))
+    {
+        load_saved_strokes(simulator, simulator.strokes.at(static_cast<size_t>(simulator.strokeIndex)));
+    }
+
+    ImGui::SameLine();
+    // the calibration records through the same stream
+    ImGui::BeginDisabled(context.calibration.active);
+    if (!inspector.recording.has_value())
+    {
+        ImGui::BeginDisabled(!inspector.input);
+        if (ImGui::Button(TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Tablet_Strokes_Record)), { buttonWidth, 0 }))
+        {
+            inspector.recording = Stroke {};
+        }
+        ImGui::EndDisabled();
+    }
+    else if (ImGui::Button(TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Tablet_Strokes_Stop)), { buttonWidth, 0 }))
+    {
+        auto recording = std::move(*inspector.recording);
+        inspector.recording.reset();
+
+        if (recording.size() != 0)
+        {
+            auto const path = make_stroke_path();
+            TRY(save_stroke(path, recording));
+
+            load_saved_strokes(simulator, path);
+        }
+    }
+    ImGui::EndDisabled();
+
+    update_stroke_simulator(simulator, curve);
+
+    if (!simulator.stroke.has_value() || simulator.stroke->size() == 0) return {};
+
+    auto const& stroke = *simulator.stroke;
+    auto const samples = static_cast<int>(stroke.size());
+
+    ImGui::TextColored(ImGui::GetStyleColorVec4(ImGuiCol_PlotLines), "%s", TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Input_Raw)));
+    ImGui::SameLine();
+    ImGui::TextColored(ImGui::GetStyleColorVec4(ImGuiCol_PlotHistogram), "%s", TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Input_Curve)));
+    ImGui::SameLine();
+    ImGui::TextDisabled("%d %s %.0f us", samples, TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Tablet_Strokes_Evaluated)), static_cast<double>(simulator.evaluationTime));
+
+    // the same overlay as the input tab, over the whole stroke instead of the last events
+    ImVec2 const plotSize { ImGui::GetContentRegionAvail().x, 80_scaled };
+    auto const plotPosition = ImGui::GetCursorPos();
+    ImGui::PlotLines("##StrokeRawPressure", stroke.pressure.data(), samples, 0, nullptr, 0.f, 1.f, plotSize);
+    ImGui::SetCursorPos(plotPosition);
+    ImGui::PushStyleColor(ImGuiCol_FrameBg, ImVec4(0, 0, 0, 0));
+    ImGui::PushStyleColor(ImGuiCol_PlotLines, ImGui::GetStyleColorVec4(ImGuiCol_PlotHistogram));
+    ImGui::PlotLines("##StrokeCurvePressure", simulator.output.data(), samples, 0, nullptr, 0.f, 1.f, plotSize);
+    ImGui::PopStyleColor(2);
+
+    // the stroke as a brush whose width follows the curve output, fitted into the canvas
+    ImVec2 const canvasSize { ImGui::GetContentRegionAvail().x, 140_scaled };
+    auto const canvasPosition = ImGui::GetCursorScreenPos();
+    auto* drawList = ImGui::GetWindowDrawList();
+    drawList->AddRectFilled(canvasPosition, { canvasPosition.x + canvasSize.x, canvasPosition.y + canvasSize.y }, ImGui::GetColorU32(ImGuiCol_FrameBg), ImGui::GetStyle().FrameRounding);
+    ImGui::Dummy(canvasSize);
+
+    auto const [minX, maxX] = std::ranges::minmax(stroke.x);
+    auto const [minY, maxY] = std::ranges::minmax(stroke.y);
+    auto const maxWidth = 12_scaled;
+    auto const margin = maxWidth;
+    auto const scale = std::min((canvasSize.x - margin * 2) / std::max(maxX - minX, 1e-6f), (canvasSize.y - margin * 2) / std::max(maxY - minY, 1e-6f));
+    ImVec2 const origin {
+        canvasPosition.x + (canvasSize.x - (maxX - minX) * scale) / 2,
+        canvasPosition.y + (canvasSize.y - (maxY - minY) * scale) / 2,
+    };
+    auto const point = [&] (size_t index) { return ImVec2 { origin.x + (stroke.x[index] - minX) * scale, origin.y + (stroke.y[index] - minY) * scale }; };
+
+    // a long stroke is thinned down to a few thousand segments, more than that can't be told apart on screen
+    static constexpr size_t MAX_SEGMENTS = 4096;
+    auto const step = std::max<size_t>(1, stroke.size() / MAX_SEGMENTS);
+    auto const colour = ImGui::GetColorU32(ImGuiCol_PlotHistogram);
+
+    drawList->PushClipRect(canvasPosition, { canvasPosition.x + canvasSize.x, canvasPosition.y + canvasSize.y }, true);
+    for (size_t index = step; index < stroke.size(); index += step)
+    {
+        // the pen was lifted between these samples
+        if (stroke.pressure[index - step] == 0 || stroke.pressure[index] == 0) continue;
+        drawList->AddLine(point(index - step), point(index), colour, 1 + simulator.output[index] * maxWidth);
+    }
+    drawList->PopClipRect();
+
+    return {};
+}
+
+liberror::Result<void> render_pressure_calibration(Context& context, DeviceSettings& deviceSettings, ApplicationSettings const& applicationSettings)
+{
+    auto& calibration = context.calibration;
+    auto& inspector = context.stylus;
+
+    if (!calibration.active)
+    {
+        ImGui::BeginDisabled(!inspector.input || inspector.recording.has_value());
+        if (ImGui::Button(TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Tablet_Calibrate)), { 250_scaled, 0 }))
+        {
+            calibration = { .active = true, .step = 0, .strokes = {} };
+            inspector.recording = Stroke {};
+        }
+        ImGui::EndDisabled();
+        return {};
+    }
+
+    static constexpr std::array PROMPTS {
+        Localisation::Tabs_Tablet_Calibration_Light,
+        Localisation::Tabs_Tablet_Calibration_Medium,
+        Localisation::Tabs_Tablet_Calibration_Firm,
+    };
+
+    auto const samples = inspector.recording.has_value() ? inspector.recording->size() : 0;
+
+    ImGui::PushTextWrapPos(ImGui::GetCursorPosX() + 250_scaled);
+    ImGui::TextWrapped("%s (%zu/%zu)", TRY(Localisation::get(applicationSettings.language, PROMPTS.at(calibration.step))), calibration.step + 1, PROMPTS.size());
+    ImGui::PopTextWrapPos();
+    ImGui::TextDisabled("%zu %s", samples, TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Tablet_Calibration_Samples)));
+
+    auto const buttonWidth = (250_scaled - ImGui::GetStyle().ItemSpacing.x) / 2;
+
+    ImGui::BeginDisabled(samples == 0);
+    auto const next = ImGui::Button(TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Tablet_Calibration_Next)), { buttonWidth, 0 });
+    ImGui::EndDisabled();
+    ImGui::SameLine();
+
+    if (ImGui::Button(TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Tablet_Calibration_Cancel)), { buttonWidth, 0 }) || !inspector.input)
+    {
+        calibration.active = false;
+        inspector.recording.reset();
+        return {};
+    }
+
+    if (!next) return {};
+
+    calibration.strokes.at(calibration.step) = std::move(*inspector.recording);
+    calibration.step += 1;
+
+    if (calibration.step < PROMPTS.size())
+    {
+        inspector.recording = Stroke {};
+        return {};
+    }
+
+    calibration.active = false;
+    inspector.recording.reset();
+
+    // the current curve is where the fit starts from, it is left alone if the strokes can't be fitted
+    if (auto const fit = fit_pressure_curve(calibration.strokes, deviceSettings.devicePressure); fit.has_value())
+    {
+        spdlog::info("Fitted the pressure curve to the calibration strokes in {} iterations, {:.3f} away from the targets", fit->iterations, fit->error);
+        deviceSettings.devicePressure = fit->curve;
+        ImGui::PushToast(TRY(Localisation::get(applicationSettings.language, Localisation::Toast_Success)), TRY(Localisation::get(applicationSettings.language, Localisation::Toast_Pressure_Curve_Fitted)));
+    }
+    else
+    {
+        spdlog::warn("{}", fit.error().message());
+        ImGui::PushToast(TRY(Localisation::get(applicationSettings.language, Localisation::Toast_Warning)), TRY(Localisation::get(applicationSettings.language, Localisation::Toast_Pressure_Curve_Fit_Failed)));
+    }
+
+    calibration.strokes = {};
+
+    return {};
+}
+
+liberror::Result<void> render_tablet_settings_tab(Context& context, DeviceSettings& deviceSettings, std::vector<libwacom::Device> const& devices, ApplicationSettings const& applicationSettings)
+{
+    ImGui::SetCursorPosX((ImGui::GetWindowWidth() - (250_scaled + 300_scaled + ImGui::GetStyle().WindowPadding.x))/2);
+
+    ImGui::BeginGroup();
+    {
+        ImGui::AlignTextToFramePadding();
+        ImGui::Text("%s", TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Tablet_Device)));
+        // the names point into the device list, so they only need rebuilding once that list is replaced
+        static std::vector<char const*> deviceNames {};
+        auto const deviceName = [] (libwacom::Device const& device) { return device.name.data(); };
+        if (!std::ranges::equal(deviceNames, devices, {}, {}, deviceName))
+        {
+            deviceNames = fplus::transform(deviceName, devices);
+        }
+        ImGui::SetNextItemWidth(300_scaled + ImGui::GetStyle().WindowPadding.x);
+        static int deviceIndex;
+        context.hasChangedDevice = ImGui::Combo("##Device", &deviceIndex, deviceNames.data(), static_cast<int>(deviceNames.size()));
+
+        if (context.hasChangedDevice)
+        {
+            context.device = devices.at(static_cast<size_t>(deviceIndex));
+            context.deviceDefaultArea = {};
+            context.deviceDefaultAreaGeneration.reset();
+            context.hasPendingDeviceDefaultArea = true;
+            open_stylus_inspector(context.stylus, context.device);
+            open_device_properties(context);
+        }
+
+        {
+            ImGui::BeginGroup();
+            {
+                ImGui::AlignTextToFramePadding();
+                ImGui::Text("%s", TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Tablet_Width)));
+                ImGui::SetNextItemWidth(150_scaled);
+                context.hasChangedDeviceArea |= ImGui::InputFloat("##TabletWidth", &deviceSettings.deviceArea.width, 0.f, 0.f, "%.0f");
+            }
+            ImGui::EndGroup();
+            ImGui::SameLine();
+            ImGui::BeginGroup();
+            {
+                ImGui::AlignTextToFramePadding();
+                ImGui::Text("%s", TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Tablet_Height)));
+                ImGui::SetNextItemWidth(150_scaled);
+                context.hasChangedDeviceArea |= ImGui::InputFloat("##TabletHeight", &deviceSettings.deviceArea.height, 0.f, 0.f, "%.0f");
+            }
+            ImGui::EndGroup();
+        }
+        {
+            ImGui::BeginGroup();
+            {
+                ImGui::AlignTextToFramePadding();
+                ImGui::Text("%s", TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Tablet_OffsetX)));
+                ImGui::SetNextItemWidth(150_scaled);
+                context.hasChangedDeviceArea |= ImGui::InputFloat("##TabletOffsetX", &deviceSettings.deviceArea.offsetX, 0.f, 0.f, "%.0f");
+            }
+            ImGui::EndGroup();
+            ImGui::SameLine();
+            ImGui::BeginGroup();
+            {
+                ImGui::AlignTextToFramePadding();
+                ImGui::Text("%s", TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Tablet_OffsetY)));
+                ImGui::SetNextItemWidth(150_scaled);
+                context.hasChangedDeviceArea |= ImGui::InputFloat("##TabletOffsetY", &deviceSettings.deviceArea.offsetY, 0.f, 0.f, "%.0f");
+            }
+            ImGui::EndGroup();
+        }
+
+        context.hasChangedDeviceArea |= ImGui::Checkbox(TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Tablet_FullArea)), &deviceSettings.deviceForceFullArea);
+        ImGui::BeginDisabled();
+        ImGui::Checkbox(TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Tablet_ForceProportions)), &deviceSettings.deviceForceAspectRatio);
+        ImGui::EndDisabled();
+    }
+    ImGui::EndGroup();
+    ImGui::SameLine();
+    ImGui::BeginGroup();
+    {
+        static float devicePressureAnchors[4] = {};
+
+        if (!devices.empty())
+        {
+            devicePressureAnchors[0] = deviceSettings.devicePressure.minX;
+            devicePressureAnchors[1] = deviceSettings.devicePressure.minY;
+            devicePressureAnchors[2] = deviceSettings.devicePressure.maxX;
+            devicePressureAnchors[3] = deviceSettings.devicePressure.maxY;
+        }
+        else
+        {
+            devicePressureAnchors[0] = 0;
+            devicePressureAnchors[1] = 0;
+            devicePressureAnchors[2] = 1;
+            devicePressureAnchors[3] = 1;
+        }
+
+        ImGui::AlignTextToFramePadding();
+        context.hasChangedDevicePressure = ImGui::BezierEditor(TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Tablet_PressureCurve)), devicePressureAnchors, { 250_scaled, 250_scaled });
+
+        if (context.hasChangedDevicePressure)
+        {
+            deviceSettings.devicePressure = { devicePressureAnchors[0], devicePressureAnchors[1], devicePressureAnchors[2], devicePressureAnchors[3] };
+        }
+
+        TRY(render_pressure_calibration(context, deviceSettings, applicationSettings));
+    }
+    ImGui::EndGroup();
+
+    ImGui::Separator();
+    TRY(render_stroke_simulator(context, deviceSettings.devicePressure, applicationSettings));
+
+    return {};
+}
+
+liberror::Result<void> render_monitor_settings_tab(Context& context, DeviceSettings& deviceSettings, std::vector<Monitor> const& monitors, ApplicationSettings const& applicationSettings)
+{
+    ImGui::SetCursorPosX((ImGui::GetWindowWidth() - (300_scaled + ImGui::GetStyle().WindowPadding.x))/2);
+
+    ImGui::BeginGroup();
+    {
+        ImGui::AlignTextToFramePadding();
         ImGui::Text("%s", TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Monitor_Monitor)));
-        auto monitorNames = fplus::transform([] (Monitor const& monitor) { return fmt::format("{} ({}x{})", monitor.name, monitor.width, monitor.height); }, monitors);
-        auto monitorNamesData = fplus::transform([] (std::string const& name) { return name.data(); }, monitorNames);
+        // formatted once per monitor layout instead of every frame
+        static std::vector<Monitor> namedMonitors {};
+        static std::vector<std::string> monitorNames {};
+        static std::vector<char const*> monitorNamesData {};
+        auto const isSameMonitor = [] (Monitor const& lhs, Monitor const& rhs) { return lhs.name == rhs.name && lhs.width == rhs.width && lhs.height == rhs.height; };
+        if (!std::ranges::equal(namedMonitors, monitors, isSameMonitor))
+        {
+            namedMonitors = monitors;
+            monitorNames = fplus::transform([] (Monitor const& monitor) { return fmt::format("{} ({}x{})", monitor.name, monitor.width, monitor.height); }, monitors);
+            monitorNamesData = fplus::transform([] (std::string const& name) { return name.data(); }, monitorNames);
+        }
         ImGui::SetNextItemWidth(300_scaled + ImGui::GetStyle().WindowPadding.x);
         static int monitorIndex;
         context.hasChangedMonitor = ImGui::Combo("##Monitors", &monitorIndex, monitorNamesData.data(), static_cast<int>(monitorNamesData.size()));
@@ -466,100 +1212,861 @@ liberror::Result<void> render_monitor_settings_tab(Context& context, DeviceSetti
             ImGui::EndGroup();
         }
 
-        context.hasChangedMonitorArea |= ImGui::Checkbox(TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Monitor_FullArea)), &deviceSettings.monitorForceFullArea);
-        ImGui::BeginDisabled();
-        ImGui::Checkbox(TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Monitor_ForceProportions)), &deviceSettings.monitorForceAspectRatio);
-        ImGui::EndDisabled();
+        context.hasChangedMonitorArea |= ImGui::Checkbox(TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Monitor_FullArea)), &deviceSettings.monitorForceFullArea);
+        ImGui::BeginDisabled();
+        ImGui::Checkbox(TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Monitor_ForceProportions)), &deviceSettings.monitorForceAspectRatio);
+        ImGui::EndDisabled();
+    }
+    ImGui::EndGroup();
+
+    return {};
+}
+
+liberror::Result<void> render_input_tab(Context const& context, ApplicationSettings const& applicationSettings)
+{
+    auto const& inspector = context.stylus;
+
+    if (!inspector.input)
+    {
+        ImGui::TextDisabled("%s", TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Input_Unavailable)));
+        return {};
+    }
+
+    ImGui::Text("%s: %.0f Hz", TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Input_Rate)), static_cast<double>(inspector.eventRate));
+    ImGui::SameLine();
+    ImGui::Text("%s: %zu", TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Input_Dropped)), inspector.input->dropped());
+
+    if (inspector.lastEvent.has_value())
+    {
+        auto const& event = *inspector.lastEvent;
+        auto const curvePressure = inspector.curvePressure[(inspector.historyOffset + StylusInspector::HISTORY_SIZE - 1) % StylusInspector::HISTORY_SIZE];
+        ImGui::Text("%s: (%.4f, %.4f)", TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Input_Position)), static_cast<double>(event.x), static_cast<double>(event.y));
+        ImGui::Text("%s: %.4f -> %.4f", TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Input_Pressure)), static_cast<double>(event.pressure), static_cast<double>(curvePressure));
+        ImGui::Text("%s: (%.3f, %.3f)", TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Input_Tilt)), static_cast<double>(event.tiltX), static_cast<double>(event.tiltY));
+    }
+
+    ImGui::TextColored(ImGui::GetStyleColorVec4(ImGuiCol_PlotLines), "%s", TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Input_Raw)));
+    ImGui::SameLine();
+    ImGui::TextColored(ImGui::GetStyleColorVec4(ImGuiCol_PlotHistogram), "%s", TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Input_Curve)));
+
+    // both series share one frame, the curve output is drawn over the raw pressure it came from
+    ImVec2 const plotSize { ImGui::GetContentRegionAvail().x, 120_scaled };
+    auto const plotPosition = ImGui::GetCursorPos();
+    ImGui::PlotLines("##RawPressure", inspector.rawPressure.data(), StylusInspector::HISTORY_SIZE, static_cast<int>(inspector.historyOffset), nullptr, 0.f, 1.f, plotSize);
+    ImGui::SetCursorPos(plotPosition);
+    ImGui::PushStyleColor(ImGuiCol_FrameBg, ImVec4(0, 0, 0, 0));
+    ImGui::PushStyleColor(ImGuiCol_PlotLines, ImGui::GetStyleColorVec4(ImGuiCol_PlotHistogram));
+    ImGui::PlotLines("##CurvePressure", inspector.curvePressure.data(), StylusInspector::HISTORY_SIZE, static_cast<int>(inspector.historyOffset), nullptr, 0.f, 1.f, plotSize);
+    ImGui::PopStyleColor(2);
+
+    return {};
+}
+
+liberror::Result<void> render_driver_tab(Context& context, ApplicationSettings const& applicationSettings)
+{
+    auto& inspector = context.driver;
+
+    // nothing is read until the tab is first looked at
+    if (!inspector.hasRead) refresh_driver_inspector(inspector);
+
+    ImGui::BeginDisabled(inspector.read.valid());
+    if (ImGui::Button(TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Driver_Refresh))))
+    {
+        refresh_driver_inspector(inspector);
+    }
+    ImGui::EndDisabled();
+
+    ImGui::SameLine();
+    ImGui::AlignTextToFramePadding();
+
+    if (inspector.read.valid())
+    {
+        ImGui::TextDisabled("%s", TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Driver_Reading)));
+    }
+    else if (inspector.hasRead)
+    {
+        auto const age = std::chrono::duration<double>(std::chrono::steady_clock::now() - inspector.readTime).count();
+        ImGui::Text("%s: %.0f s (%.1f ms)", TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Driver_Read)), age, static_cast<double>(inspector.readDuration));
+    }
+
+    inspector.filter.Draw(TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Driver_Search)), 300_scaled);
+
+    if (inspector.error.has_value())
+    {
+        ImGui::TextDisabled("%s", inspector.error->data());
+        return {};
+    }
+
+    // the table stops short of the apply button at the bottom of the window
+    auto const height = std::max(ImGui::GetContentRegionAvail().y - (35_scaled + ImGui::GetStyle().WindowPadding.y * 2), 100_scaled);
+
+    if (ImGui::BeginTable("##Driver", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY | ImGuiTableFlags_Resizable, { 0, height }))
+    {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn(TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Driver_Device)));
+        ImGui::TableSetupColumn(TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Driver_Property)));
+        ImGui::TableSetupColumn(TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Driver_Type)));
+        ImGui::TableSetupColumn(TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Driver_Value)));
+        ImGui::TableHeadersRow();
+
+        for (auto const& row : inspector.rows)
+        {
+            auto const matches = inspector.filter.PassFilter(row.device.data()) || inspector.filter.PassFilter(row.property.data()) || inspector.filter.PassFilter(row.value.data());
+            if (!matches) continue;
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(row.device.data());
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(row.property.data());
+            ImGui::TableNextColumn();
+            ImGui::TextDisabled("%s", row.type.data());
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(row.value.data());
+        }
+
+        ImGui::EndTable();
+    }
+
+    return {};
+}
+
+liberror::Result<void> render_window(DeviceSettings& deviceSettings, std::vector<libwacom::Device> const& devices, std::vector<Tablet> const& tablets, std::vector<Monitor> const& monitors, ApplicationSettings const& applicationSettings)
+{
+    static Context context = [&] () {
+        libwacom::Device device = devices.empty() ? libwacom::Device {} : devices.front();
+        libwacom::Area deviceDefaultArea {};
+        Monitor monitor = *std::ranges::find_if(monitors, &Monitor::primary);
+        libwacom::Area monitorDefaultArea = monitors.empty() ? libwacom::Area {} : libwacom::Area { 0, 0, monitor.width, monitor.height };
+        // every device the settings are written to was grouped at startup, an apply only has to pick its tablet
+        Context initial { device, deviceDefaultArea, tablets, monitor, monitorDefaultArea };
+        load_saved_strokes(initial.simulator);
+        if (!devices.empty())
+        {
+            open_stylus_inspector(initial.stylus, device);
+            open_device_properties(initial);
+        }
+        return initial;
+    }();
+
+    update_stylus_inspector(context.stylus, deviceSettings.devicePressure);
+    update_device_properties(context, deviceSettings);
+    update_driver_inspector(context.driver);
+
+    // picks up the default area once a worker read it, or once the driver reported a different one than was cached
+    if (!devices.empty() && context.deviceDefaultAreaGeneration != the_default_area_cache().generation())
+    {
+        context.deviceDefaultAreaGeneration = the_default_area_cache().generation();
+
+        if (auto const area = TRY(the_default_area_cache().get(context.device)); area.has_value())
+        {
+            context.deviceDefaultArea = *area;
+
+            // a device that was just picked starts out on its whole area
+            if (context.hasPendingDeviceDefaultArea) deviceSettings.deviceArea = *area;
+            context.hasPendingDeviceDefaultArea = false;
+        }
+    }
+
+    if (devices.empty() && deviceSettings.devicePressure.minX == -1 && deviceSettings.devicePressure.minY == -1 && deviceSettings.deviceArea.width == -1 && deviceSettings.deviceArea.height == -1)
+    {
+        ImGui::PushToast(TRY(Localisation::get(applicationSettings.language, Localisation::Toast_Warning)), TRY(Localisation::get(applicationSettings.language, Localisation::Toast_Devices_Missing)));
+        deviceSettings.deviceArea = { 0, 0, 0, 0 };
+        deviceSettings.devicePressure = { 0, 0, 1, 1 };
+        deviceSettings.monitorArea = context.monitorDefaultArea;
+    }
+
+    if (!devices.empty() && deviceSettings.devicePressure.minX == -1 && deviceSettings.devicePressure.minY == -1 && deviceSettings.deviceArea.width == -1 && deviceSettings.deviceArea.height == -1)
+    {
+        if (std::filesystem::exists(DEVICE_SETTINGS_FILE))
+        {
+            if (!load_device_settings(deviceSettings))
+            {
+                ImGui::PushToast(TRY(Localisation::get(applicationSettings.language, Localisation::Toast_Warning)), TRY(Localisation::get(applicationSettings.language, Localisation::Toast_Device_Settings_Load_Failed)));
+            }
+            else
+            {
+                context.savedSettings = deviceSettings;
+            }
+        }
+        else
+        {
+            ImGui::PushToast(TRY(Localisation::get(applicationSettings.language, Localisation::Toast_Warning)), TRY(Localisation::get(applicationSettings.language, Localisation::Toast_Device_Settings_Missing)));
+            deviceSettings.deviceName = context.device.name;
+            deviceSettings.deviceArea = MUST(the_backend().get_stylus_area(context.device.id));
+            deviceSettings.devicePressure = MUST(the_backend().get_stylus_pressure_curve(context.device.id));
+            deviceSettings.monitorName = context.monitor.name;
+            deviceSettings.monitorArea = context.monitorDefaultArea;
+            if (save_device_settings(deviceSettings)) context.savedSettings = deviceSettings;
+        }
+    }
+
+    ImGui::BeginGroup();
+    {
+        TRY(render_region_mappers(context, deviceSettings, applicationSettings));
+    }
+    ImGui::EndGroup();
+
+    if (ImGui::BeginTabBar("##Tabs_1"))
+    {
+        if (ImGui::BeginTabItem(TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Tablet_Title))))
+        {
+            TRY(render_tablet_settings_tab(context, deviceSettings, devices, applicationSettings));
+            ImGui::EndTabItem();
+        }
+
+        if (ImGui::BeginTabItem(TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Monitor_Title))))
+        {
+            TRY(render_monitor_settings_tab(context, deviceSettings, monitors, applicationSettings));
+            ImGui::EndTabItem();
+        }
+
+        if (ImGui::BeginTabItem(TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Input_Title))))
+        {
+            TRY(render_input_tab(context, applicationSettings));
+            ImGui::EndTabItem();
+        }
+
+        if (ImGui::BeginTabItem(TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Driver_Title))))
+        {
+            TRY(render_driver_tab(context, applicationSettings));
+            ImGui::EndTabItem();
+        }
+
+        ImGui::EndTabBar();
+    }
+
+    auto previousCursorPosition = ImGui::GetCursorPos();
+    ImGui::SetCursorPosY(ImGui::GetWindowHeight() - (35_scaled + ImGui::GetStyle().WindowPadding.x));
+    if (ImGui::Button(TRY(Localisation::get(applicationSettings.language, Localisation::Save_Apply)), { 200_scaled, 35_scaled }))
+    {
+        if (save_device_settings(deviceSettings))
+        {
+            ImGui::PushToast(TRY(Localisation::get(applicationSettings.language, Localisation::Toast_Success)), TRY(Localisation::get(applicationSettings.language, Localisation::Toast_Device_Settings_Saved)));
+            context.savedSettings = deviceSettings;
+        }
+
+        TRY(set_settings_to_tablet(find_tablet(context.tablets, context.device), context.monitor, deviceSettings));
+
+        // what was just written comes back through the watcher, it is already known and not a change
+        if (context.deviceProperties)
+        {
+            context.deviceState.area = deviceSettings.deviceArea;
+            context.deviceState.pressure = deviceSettings.devicePressure;
+        }
+    }
+
+    if (differs_from_saved_settings(context))
+    {
+        ImGui::SameLine();
+        ImGui::AlignTextToFramePadding();
+        ImGui::TextColored(ImGui::GetStyleColorVec4(ImGuiCol_PlotLinesHovered), "%s", TRY(Localisation::get(applicationSettings.language, Localisation::Save_Device_Differs)));
+    }
+    ImGui::SetCursorPos(previousCursorPosition);
+
+    return {};
+}
+
+liberror::Result<void> render_frame(ImVec2 windowSize, ImFont* font, DeviceSettings& deviceSettings, std::vector<libwacom::Device> const& devices, std::vector<Tablet> const& tablets, std::vector<Monitor> const& monitors, ApplicationSettings& applicationSettings)
+{
+    // the style is only rewritten when the theme changes, the very first frame always applies it
+    static std::optional<std::string> appliedTheme {};
+    if (appliedTheme != applicationSettings.theme)
+    {
+        apply_theme(applicationSettings.theme);
+        appliedTheme = applicationSettings.theme;
+    }
+
+    ImGui::PushFont(font);
+    {
+        ImGui::SetNextWindowPos({});
+        ImGui::SetNextWindowSize(windowSize);
+        ImGui::Begin(NAME, nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoBringToFrontOnFocus | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_MenuBar);
+        ImGui::RenderToasts();
+        {
+            static bool isApplicationSettingsOpen = false;
+            static bool isGoddessOpen = false;
+            static bool isMemoryOpen = false;
+            static GoddessImage goddess {};
+
+            if (ImGui::BeginMenuBar())
+            {
+                if (ImGui::BeginMenu(TRY(Localisation::get(applicationSettings.language, Localisation::MenuBar_Settings))))
+                {
+                    if (ImGui::MenuItem(TRY(Localisation::get(applicationSettings.language, Localisation::MenuBar_Settings_Application))))
+                    {
+                        isApplicationSettingsOpen = true;
+                    }
+
+                    ImGui::EndMenu();
+                }
+
+                if (ImGui::BeginMenu(TRY(Localisation::get(applicationSettings.language, Localisation::MenuBar_Other))))
+                {
+                    if (ImGui::MenuItem(TRY(Localisation::get(applicationSettings.language, Localisation::MenuBar_Other_Goddess))))
+                    {
+                        isGoddessOpen = true;
+                    }
+
+                    if (ImGui::MenuItem(TRY(Localisation::get(applicationSettings.language, Localisation::MenuBar_Other_Memory))))
+                    {
+                        isMemoryOpen = true;
+                    }
+
+                    ImGui::EndMenu();
+                }
+
+                ImGui::EndMenuBar();
+            }
+
+            if (isApplicationSettingsOpen)
+            {
+                float applicationSettingsWidth = windowSize.x/1.5f, applicationSettingsHeight = windowSize.y/1.5f;
+                ImGui::SetNextWindowSize({ applicationSettingsWidth, applicationSettingsHeight });
+                ImGui::SetNextWindowPos({ (windowSize.x - applicationSettingsWidth)/2, (windowSize.y - applicationSettingsHeight)/2 });
+                ImGui::Begin(
+                    TRY(Localisation::get(applicationSettings.language, Localisation::MenuBar_Settings_Application)),
+                    &isApplicationSettingsOpen,
+                    ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoSavedSettings
+                );
+                {
+                    render_settings_popup(applicationSettings);
+                }
+                ImGui::End();
+            }
+
+            if (isGoddessOpen)
+            {
+                float goddessWidth = windowSize.x/1.5f, goddessHeight = windowSize.y/1.5f;
+                ImGui::SetNextWindowSize({ goddessWidth, goddessHeight });
+                ImGui::SetNextWindowPos({ (windowSize.x - goddessWidth)/2, (windowSize.y - goddessHeight)/2 });
+                ImGui::Begin(
+                    TRY(Localisation::get(applicationSettings.language, Localisation::MenuBar_Other_Goddess)),
+                    &isGoddessOpen,
+                    ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoSavedSettings
+                );
+                {
+                    render_goddess_popup(goddess);
+                }
+                ImGui::End();
+            }
+
+            if (isMemoryOpen)
+            {
+                float memoryWidth = windowSize.x/1.5f, memoryHeight = windowSize.y/1.5f;
+                ImGui::SetNextWindowSize({ memoryWidth, memoryHeight });
+                ImGui::SetNextWindowPos({ (windowSize.x - memoryWidth)/2, (windowSize.y - memoryHeight)/2 });
+                ImGui::Begin(
+                    TRY(Localisation::get(applicationSettings.language, Localisation::MenuBar_Other_Memory)),
+                    &isMemoryOpen,
+                    ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoSavedSettings
+                );
+                {
+                    TRY(render_memory_popup(applicationSettings));
+                }
+                ImGui::End();
+            }
+
+            // whatever only a closed popup needed is let go of
+            if (!isApplicationSettingsOpen) release_font_list();
+            if (!isGoddessOpen) release_goddess_image(goddess);
+            Localisation::release_unused(applicationSettings.language);
+
+            ImGui::BeginDisabled(devices.empty());
+            {
+                TRY(render_window(deviceSettings, devices, tablets, monitors, applicationSettings));
+            }
+            ImGui::EndDisabled();
+        }
+        ImGui::End();
+    }
+    ImGui::PopFont();
+
+    return {};
+}
+
+void push_headless_input(ImGuiIO& io, size_t frame)
+{
+    // sweeps the pointer across the region mappers and the tabs below them, holding the left button
+    // down on every other pass. the menu bar and the save button are kept out of reach so that a run
+    // never opens a popup that writes to disk.
+    static constexpr size_t FRAMES_PER_PASS = 240;
+
+    auto const t = static_cast<float>(frame % FRAMES_PER_PASS) / FRAMES_PER_PASS;
+    auto const pass = frame / FRAMES_PER_PASS;
+
+    io.AddMousePosEvent(
+        io.DisplaySize.x * (0.1f + 0.8f * t),
+        io.DisplaySize.y * (0.35f + 0.25f * std::sin(t * 2 * std::numbers::pi_v<float>))
+    );
+    io.AddMouseButtonEvent(ImGuiMouseButton_Left, pass % 2 == 1 && t > 0.05f && t < 0.95f);
+}
+
+struct HeadlessRun
+{
+    std::vector<FrameSample> samples;
+    // taken right before the context goes away, along with everything imgui holds
+    std::optional<MemoryReport> memoryReport;
+};
+
+// with a software renderer in use every frame is also drawn, after it has been timed, and handed to afterFrame
+liberror::Result<HeadlessRun> run_headless_frames(size_t frames, ImVec2 displaySize, std::function<void(ImGuiIO&, size_t)> const& pushInput, bool memoryReport, DeviceSettings& deviceSettings, std::vector<libwacom::Device> const& devices, std::vector<Tablet> const& tablets, std::vector<Monitor> const& monitors, ApplicationSettings& applicationSettings, std::function<liberror::Result<void>(size_t)> const& afterFrame = {})
+{
+    install_imgui_allocation_counter();
+
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+
+    auto& io = ImGui::GetIO();
+
+    io.IniFilename = nullptr;
+    io.LogFilename = nullptr;
+    io.DisplaySize = displaySize;
+    io.DeltaTime = 1.f / 60.f;
+
+    // without a renderer the atlas only has to be built so that NewFrame accepts it
+    unsigned char* pixels = nullptr;
+    int width = 0, height = 0;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    set_memory_usage("font atlas", get_font_atlas_memory_usage(*io.Fonts));
+
+    if (the_software_renderer() != nullptr)
+    {
+        io.Fonts->SetTexID(create_texture(width, height, reinterpret_cast<uint32_t const*>(pixels)));
+    }
+
+    HeadlessRun run {};
+    run.samples.reserve(frames);
+
+    for (size_t frame = 0; frame < frames; frame += 1)
+    {
+        TRACE_SCOPE("frame");
+
+        pushInput(io, frame);
+
+        auto const allocations = get_imgui_allocation_count();
+        auto const heapAllocations = get_heap_allocation_count();
+        auto const begin = std::chrono::steady_clock::now();
+
+        ImGui::NewFrame();
+        TRY(render_frame(io.DisplaySize, nullptr, deviceSettings, devices, tablets, monitors, applicationSettings));
+        ImGui::Render();
+
+        run.samples.push_back({ std::chrono::steady_clock::now() - begin, get_imgui_allocation_count() - allocations, get_heap_allocation_count() - heapAllocations });
+
+        if (auto* renderer = the_software_renderer(); renderer != nullptr)
+        {
+            TRY(renderer->render(*ImGui::GetDrawData()));
+        }
+
+        if (afterFrame) TRY(afterFrame(frame));
+    }
+
+    if (memoryReport)
+    {
+        run.memoryReport = TRY(get_memory_report());
+    }
+
+    ImGui::DestroyContext();
+
+    return run;
+}
+
+// the device settings a headless run starts from, read off the first of the (fake) devices and the primary monitor
+liberror::Result<DeviceSettings> make_headless_device_settings(DeviceSettings deviceSettings, std::vector<libwacom::Device> const& devices, std::vector<Monitor> const& monitors)
+{
+    auto const& device = devices.front();
+    auto const& monitor = *std::ranges::find_if(monitors, &Monitor::primary);
+
+    deviceSettings.deviceName = device.name;
+    deviceSettings.deviceArea = TRY(the_backend().get_stylus_area(device.id));
+    deviceSettings.devicePressure = TRY(the_backend().get_stylus_pressure_curve(device.id));
+    deviceSettings.monitorName = monitor.name;
+    deviceSettings.monitorArea = { 0, 0, monitor.width, monitor.height };
+
+    return deviceSettings;
+}
+
+// a scenario is built against the fake backend like --headless-frames and every frame is drawn by the software
+// renderer, so that the captures come out the same on any machine whatever its gpu
+liberror::Result<void> run_scenario(Scenario const& scenario, std::filesystem::path const& goldens, bool updateGoldens, DeviceSettings& deviceSettings, std::vector<libwacom::Device> const& devices, std::vector<Tablet> const& tablets, std::vector<Monitor> const& monitors)
+{
+    ApplicationSettings applicationSettings {
+        .scale = 1.0,
+        .theme = "DARK",
+        .language = ApplicationSettings::Language::EN_US,
+        .font = "default",
+    };
+
+    set_scale(applicationSettings.scale);
+
+    auto renderer = SoftwareRenderer::open_offscreen();
+    the_software_renderer() = renderer.get();
+
+    std::vector<std::string> failures {};
+    size_t captures = 0, written = 0;
+
+    auto const pushInput = [&] (ImGuiIO& io, size_t frame) {
+        auto const& step = scenario.frames[frame];
+
+        if (step.mouse.has_value()) io.AddMousePosEvent(step.mouse->x, step.mouse->y);
+        if (step.leftButton.has_value()) io.AddMouseButtonEvent(ImGuiMouseButton_Left, *step.leftButton);
+        if (step.theme.has_value()) applicationSettings.theme = *step.theme;
+        if (step.language.has_value()) applicationSettings.language = *step.language;
+
+        if (step.scale.has_value())
+        {
+            applicationSettings.scale = *step.scale;
+            set_scale(applicationSettings.scale);
+            io.DisplaySize = { 800_scaled, 815_scaled };
+        }
+    };
+
+    auto const afterFrame = [&] (size_t frame) -> liberror::Result<void> {
+        auto const& capture = scenario.frames[frame].capture;
+        if (!capture.has_value()) return {};
+
+        captures += 1;
+
+        auto const pixels = renderer->pixels();
+        Image const image { renderer->frame_width(), renderer->frame_height(), { pixels.begin(), pixels.end() } };
+        auto const golden = goldens / fmt::format("{}-{}.ppm", scenario.name, *capture);
+
+        if (updateGoldens)
+        {
+            TRY(save_image(golden, image));
+            written += 1;
+            return {};
+        }
+
+        // a capture nobody looked at yet proves nothing, it has to be written on purpose
+        if (!std::filesystem::exists(golden))
+        {
+            failures.push_back(fmt::format("\"{}\" has no golden image, --update-goldens writes it", *capture));
+            TRY(save_image(goldens / "failed" / fmt::format("{}-{}.ppm", scenario.name, *capture), image));
+            return {};
+        }
+
+        auto const comparison = compare_images(TRY(load_image(golden)), image, scenario.tolerance);
+        auto const allowed = static_cast<size_t>(scenario.differingPixels * static_cast<double>(image.pixels.size()));
+
+        if (comparison.differingPixels > allowed)
+        {
+            failures.push_back(fmt::format("\"{}\" differs from its golden image in {} pixels, by up to {}", *capture, comparison.differingPixels, comparison.maxDifference));
+            TRY(save_image(goldens / "failed" / fmt::format("{}-{}.ppm", scenario.name, *capture), image));
+            TRY(save_image(goldens / "failed" / fmt::format("{}-{}.diff.ppm", scenario.name, *capture), comparison.difference));
+        }
+
+        return {};
+    };
+
+    auto const run = run_headless_frames(scenario.frames.size(), { 800_scaled, 815_scaled }, pushInput, false, deviceSettings, devices, tablets, monitors, applicationSettings, afterFrame);
+    the_software_renderer() = nullptr;
+    TRY(run);
+
+    // the first frame and those that change a setting pay for loading things once, they are not held to the budget
+    double slowest = 0;
+    size_t slowestFrame = 0;
+
+    for (size_t frame = 1; frame < run->samples.size(); frame += 1)
+    {
+        auto const& step = scenario.frames[frame];
+        if (step.theme.has_value() || step.language.has_value() || step.scale.has_value()) continue;
+
+        auto const duration = std::chrono::duration<double, std::micro>(run->samples[frame].duration).count();
+        if (duration > slowest)
+        {
+            slowest = duration;
+            slowestFrame = frame;
+        }
+    }
+
+    if (slowest > scenario.budgetUs)
+    {
+        failures.push_back(fmt::format("frame {} took {:.0f} us, over the budget of {:.0f} us", slowestFrame, slowest, scenario.budgetUs));
+    }
+
+    fmt::println("{:<24} {:>5} frames  slowest {:>8.1f} us  {:>2} captures  {}{}", scenario.name, scenario.frames.size(), slowest, captures, failures.empty() ? "ok" : "FAILED", written != 0 ? fmt::format(" ({} golden images written)", written) : "");
+    for (auto const& failure : failures) fmt::println("    {}", failure);
+
+    if (!failures.empty())
+        return liberror::make_error("The scenario {} failed", scenario.name);
+
+    return {};
+}
+
+// every scenario runs in a process of its own, the ui keeps state in statics that would otherwise carry
+// over from one scenario into the next. they run one after the other so that their frame times are not skewed.
+liberror::Result<void> run_scenarios(std::filesystem::path const& directory, bool updateGoldens)
+{
+    auto const scenarios = find_scenarios(directory);
+    if (scenarios.empty())
+        return liberror::make_error("No scenarios were found in {}", directory.string());
+
+    size_t failed = 0;
+
+    for (auto const& scenario : scenarios)
+    {
+        std::vector<std::string> command { "/proc/self/exe", fmt::format("--scenario={}", scenario.string()), fmt::format("--goldens={}", (directory / "golden").string()) };
+        if (updateGoldens) command.emplace_back("--update-goldens");
+
+        auto const result = TRY(run_process(command, { .timeout = std::chrono::minutes(1) }));
+
+        fmt::print("{}", result.output);
+
+        if (result.exitStatus != 0)
+        {
+            fmt::print(stderr, "{}", result.error);
+            failed += 1;
+        }
+    }
+
+    if (failed != 0)
+        return liberror::make_error("{} of {} scenarios failed", failed, scenarios.size());
+
+    return {};
+}
+
+// the settings files are never read nor written by a replay so that it does not depend on, or
+// clobber, the user configuration. the recorded device settings are handed to it from a scratch directory.
+liberror::Result<void> replay_session(Session& session, size_t const& unrecordedCalls, bool memoryReport, DeviceSettings& deviceSettings, std::vector<libwacom::Device> const& devices, std::vector<Tablet> const& tablets, std::vector<Monitor> const& monitors)
+{
+    auto const scratch = std::filesystem::temp_directory_path() / fmt::format("{}-replay-{}", NAME, getpid());
+    std::filesystem::create_directories(scratch);
+
+    DEVICE_SETTINGS_FILE = scratch / "device.json";
+    APPLICATION_SETTINGS_FILE = scratch / "application.json";
+
+    if (session.deviceSettingsFile.has_value())
+    {
+        std::ofstream stream(DEVICE_SETTINGS_FILE);
+        stream << *session.deviceSettingsFile;
+    }
+
+    auto applicationSettings = session.applicationSettings;
+    set_scale(session.scale);
+
+    auto const run = run_headless_frames(session.frames.size(), session.windowSize, [&session] (ImGuiIO& io, size_t frame) {
+        push_frame_input(io, session.frames[frame]);
+    }, memoryReport, deviceSettings, devices, tablets, monitors, applicationSettings);
+
+    std::filesystem::remove_all(scratch);
+
+    print_replay_comparison(session.frames, TRY(run).samples, unrecordedCalls);
+
+    if (run->memoryReport.has_value())
+    {
+        fmt::println("");
+        print_memory_report(*run->memoryReport);
+    }
+
+    return {};
+}
+
+// without opengl the window is left without a client api, for the software renderer to draw into
+GLFWwindow* create_window(bool withOpenGL)
+{
+    glfwDefaultWindowHints();
+
+    if (withOpenGL)
+    {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    }
+    else
+    {
+        glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+    }
+
+    glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+
+#ifdef DEBUG
+    return glfwCreateWindow(static_cast<int>(800_scaled), static_cast<int>(815_scaled), NAME " - DEBUG BUILD", nullptr, nullptr);
+#else
+    return glfwCreateWindow(static_cast<int>(800_scaled), static_cast<int>(815_scaled), NAME, nullptr, nullptr);
+#endif
+}
+
+// the content scale of the monitor under the center of the window, as glfw on X11 only reports a
+// single one for the whole window
+float get_window_content_scale(GLFWwindow* window)
+{
+    int windowX, windowY, windowWidth, windowHeight;
+    glfwGetWindowPos(window, &windowX, &windowY);
+    glfwGetWindowSize(window, &windowWidth, &windowHeight);
+    auto const centerX = windowX + windowWidth/2, centerY = windowY + windowHeight/2;
+
+    int count = 0;
+    auto const monitors = glfwGetMonitors(&count);
+
+    for (auto monitor : std::span(monitors, static_cast<size_t>(count)))
+    {
+        int monitorX, monitorY;
+        glfwGetMonitorPos(monitor, &monitorX, &monitorY);
+        auto const mode = glfwGetVideoMode(monitor);
+
+        if (centerX >= monitorX && centerX < monitorX + mode->width && centerY >= monitorY && centerY < monitorY + mode->height)
+        {
+            float scaleX, scaleY;
+            glfwGetMonitorContentScale(monitor, &scaleX, &scaleY);
+            return scaleX;
+        }
+    }
+
+    float scaleX, scaleY;
+    glfwGetWindowContentScale(window, &scaleX, &scaleY);
+    return scaleX;
+}
+
+// applies the profile picked for the focused window until interrupted. the watcher sleeps on the X
+// connection and this thread on the signals, so nothing runs in between two focus changes.
+liberror::Result<void> follow_window_focus(Tablet const& tablet, std::vector<Monitor> const& monitors)
+{
+    if (monitors.empty())
+    {
+        return liberror::make_error("Failed to load monitors");
     }
-    ImGui::EndGroup();
 
-    return {};
+    auto const rules = TRY(compile_profile_rules(PROFILE_RULES_FILE, tablet, monitors));
+
+    // blocked before the watcher starts so that it inherits the mask and the signals are left to sigwait
+    sigset_t signals {};
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    Profile const* applied = nullptr;
+    liberror::Result<void> watched {};
+
+    std::jthread watcher { [&] (std::stop_token token) {
+        watched = watch_window_focus(token, [&] (WindowClass const& windowClass) {
+            auto const& profile = match_profile(rules, windowClass);
+            if (&profile == applied) return;
+
+            // a failed write leaves the device in an unknown state, so the next profile is written whole
+            auto const previous = applied ? std::span(applied->states) : std::span<DeviceState const> {};
+            if (auto result = apply_tablet_state(tablet, profile.states, previous); !result.has_value())
+            {
+                spdlog::error("Failed to apply the profile \"{}\": {}", profile.name, result.error().message());
+                applied = nullptr;
+                return;
+            }
+
+            spdlog::info("Applied the profile \"{}\" for {}", profile.name, windowClass.name.empty() ? "the desktop" : windowClass.name);
+            applied = &profile;
+        });
+
+        if (!token.stop_requested()) kill(getpid(), SIGTERM);
+    }};
+
+    int received = 0;
+    sigwait(&signals, &received);
+
+    watcher.request_stop();
+    watcher.join();
+
+    return watched;
 }
 
-liberror::Result<void> render_window(DeviceSettings& deviceSettings, std::vector<libwacom::Device> const& devices, std::vector<Monitor> const& monitors, ApplicationSettings const& applicationSettings)
+liberror::Result<void> safe_main(std::vector<std::string_view> const& arguments)
 {
-    static Context context = [&] () {
-        libwacom::Device device = devices.empty() ? libwacom::Device {} : devices.front();
-        libwacom::Area deviceDefaultArea = devices.empty() ? libwacom::Area {} : MUST(libwacom::get_stylus_default_area(device.id));
-        Monitor monitor = *std::ranges::find_if(monitors, &Monitor::primary);
-        libwacom::Area monitorDefaultArea = monitors.empty() ? libwacom::Area {} : libwacom::Area { 0, 0, monitor.width, monitor.height };
-        return Context { device, deviceDefaultArea, monitor, monitorDefaultArea };
-    }();
+    // every connection to the X server, ours and those of the xsetwacom processes, goes to the display asked for
+    if (auto const display = find_option(arguments, "--display"); display.has_value())
+    {
+        setenv("DISPLAY", std::string(*display).data(), 1);
+    }
 
-    if (devices.empty() && deviceSettings.devicePressure.minX == -1 && deviceSettings.devicePressure.minY == -1 && deviceSettings.deviceArea.width == -1 && deviceSettings.deviceArea.height == -1)
+    if (auto const file = find_option(arguments, "--device-settings"); file.has_value())
     {
-        ImGui::PushToast(TRY(Localisation::get(applicationSettings.language, Localisation::Toast_Warning)), TRY(Localisation::get(applicationSettings.language, Localisation::Toast_Devices_Missing)));
-        deviceSettings.deviceArea = { 0, 0, 0, 0 };
-        deviceSettings.devicePressure = { 0, 0, 1, 1 };
-        deviceSettings.monitorArea = context.monitorDefaultArea;
+        DEVICE_SETTINGS_FILE = *file;
     }
 
-    if (!devices.empty() && deviceSettings.devicePressure.minX == -1 && deviceSettings.devicePressure.minY == -1 && deviceSettings.deviceArea.width == -1 && deviceSettings.deviceArea.height == -1)
+    // nothing is asked of the display this was started on, which there may not even be
+    if (auto const displays = find_option(arguments, "--displays"); displays.has_value())
     {
-        if (std::filesystem::exists(DEVICE_SETTINGS_FILE))
-        {
-            if (!load_device_settings(deviceSettings))
-            {
-                ImGui::PushToast(TRY(Localisation::get(applicationSettings.language, Localisation::Toast_Warning)), TRY(Localisation::get(applicationSettings.language, Localisation::Toast_Device_Settings_Load_Failed)));
-            }
-        }
-        else
-        {
-            ImGui::PushToast(TRY(Localisation::get(applicationSettings.language, Localisation::Toast_Warning)), TRY(Localisation::get(applicationSettings.language, Localisation::Toast_Device_Settings_Missing)));
-            deviceSettings.deviceName = context.device.name;
-            deviceSettings.deviceArea = MUST(libwacom::get_stylus_area(context.device.id));
-            deviceSettings.devicePressure = MUST(libwacom::get_stylus_pressure_curve(context.device.id));
-            deviceSettings.monitorName = context.monitor.name;
-            deviceSettings.monitorArea = context.monitorDefaultArea;
-            save_device_settings(deviceSettings);
-        }
+        std::vector<std::string> list {};
+        for (auto display : std::views::split(*displays, ',')) list.emplace_back(display.begin(), display.end());
+        if (displays->empty()) list = find_displays();
+
+        if (list.empty())
+            return liberror::make_error("No X displays were found");
+
+        auto const report = apply_settings_to_displays(list);
+        fmt::println("{}", report.dump(4));
+
+        if (auto const failed = report["failed"].get<size_t>(); failed != 0)
+            return liberror::make_error("{} of {} displays failed", failed, list.size());
+
+        return {};
     }
 
-    ImGui::BeginGroup();
+    if (is_command(arguments))
     {
-        render_region_mappers(context, deviceSettings, devices, monitors, applicationSettings);
+        return run_command(arguments);
     }
-    ImGui::EndGroup();
 
-    if (ImGui::BeginTabBar("##Tabs_1"))
+    auto const headlessFrames = find_option(arguments, "--headless-frames");
+    auto const memoryReport = find_option(arguments, "--mem-report").has_value();
+    auto const recordPath = find_option(arguments, "--record");
+    auto const replayPath = find_option(arguments, "--replay");
+    auto const scenarioPath = find_option(arguments, "--scenario");
+
+    // the backend keeps a reference to the session, which is why both outlive this function
+    static Session session {};
+    static size_t unrecordedCalls = 0;
+
+    if (headlessFrames.has_value() || scenarioPath.has_value())
     {
-        if (ImGui::BeginTabItem(TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Tablet_Title))))
-        {
-            TRY(render_tablet_settings_tab(context, deviceSettings, devices, applicationSettings));
-            ImGui::EndTabItem();
-        }
+        set_backend(make_fake_backend());
+    }
 
-        if (ImGui::BeginTabItem(TRY(Localisation::get(applicationSettings.language, Localisation::Tabs_Monitor_Title))))
-        {
-            TRY(render_monitor_settings_tab(context, deviceSettings, monitors, applicationSettings));
-            ImGui::EndTabItem();
-        }
+    if (recordPath.has_value())
+    {
+        set_backend(make_recording_backend(the_backend(), session));
+    }
 
-        ImGui::EndTabBar();
+    if (replayPath.has_value())
+    {
+        TRY(load_session(*replayPath, session));
+        set_backend(make_replay_backend(session, make_fake_backend(), unrecordedCalls));
     }
 
-    auto previousCursorPosition = ImGui::GetCursorPos();
-    ImGui::SetCursorPosY(ImGui::GetWindowHeight() - (35_scaled + ImGui::GetStyle().WindowPadding.x));
-    if (ImGui::Button(TRY(Localisation::get(applicationSettings.language, Localisation::Save_Apply)), { 200_scaled, 35_scaled }))
+    // the scenarios run in processes of their own against the fake backend, nothing is asked of the X server here
+    if (auto const scenarios = find_option(arguments, "--scenarios"); scenarios.has_value())
     {
-        if (save_device_settings(deviceSettings))
-        {
-            ImGui::PushToast(TRY(Localisation::get(applicationSettings.language, Localisation::Toast_Success)), TRY(Localisation::get(applicationSettings.language, Localisation::Toast_Device_Settings_Saved)));
-        }
+        return run_scenarios(scenarios->empty() ? "scenarios" : std::filesystem::path(*scenarios), find_option(arguments, "--update-goldens").has_value());
+    }
 
-        TRY(set_settings_to_device(context.device, context.monitor, deviceSettings));
+    // only the cpu is measured, it has no need for the X server either
+    if (auto const benchmarkCurveFit = find_option(arguments, "--benchmark-curve-fit"); benchmarkCurveFit.has_value())
+    {
+        auto const runs = benchmarkCurveFit->empty() ? 100 : TRY(parse_count(*benchmarkCurveFit));
+        fmt::println("{}", benchmark_pressure_fit(runs).dump(4));
+        return {};
     }
-    ImGui::SetCursorPos(previousCursorPosition);
 
-    return {};
-}
+    // any other XInput device is measured as it is, without the driver nor xrandr, so that it also works under Xvfb
+    if (auto const measureDevice = find_option(arguments, "--measure-device"); measureDevice.has_value() && find_option(arguments, "--measure-input").has_value())
+    {
+        auto const measureInput = *find_option(arguments, "--measure-input");
+        auto const seconds = measureInput.empty() ? 10 : TRY(parse_count(measureInput));
 
-liberror::Result<void> safe_main(std::vector<std::string_view> const& arguments)
-{
-    std::vector<Monitor> monitors = TRY(get_available_monitors());
-    std::vector<libwacom::Device> devices = TRY(libwacom::get_available_devices());
+        auto const capture = TRY(capture_input(*measureDevice, std::chrono::seconds(seconds)));
+        fmt::println("{}", analyse_input_capture(capture, std::nullopt).dump(4));
+
+        return {};
+    }
+
+    TraceSpan queryBackend { "startup::query_backend" };
+
+    std::vector<Monitor> monitors = TRY(the_backend().get_available_monitors());
+    std::vector<libwacom::Device> devices = TRY(the_backend().get_available_devices());
+    auto const tablets = group_devices_by_tablet(devices);
     devices = fplus::keep_if([] (auto&& device) { return device.kind == libwacom::Device::Kind::STYLUS; }, devices);
 
+    queryBackend.end();
+
     DeviceSettings deviceSettings {
         .deviceName = "INVALID",
         .deviceArea = { -1, -1, -1, -1 },
@@ -569,7 +2076,8 @@ liberror::Result<void> safe_main(std::vector<std::string_view> const& arguments)
         .monitorName = "INVALID",
         .monitorArea = { -1, -1, -1, -1 },
         .monitorForceFullArea = false,
-        .monitorForceAspectRatio = false
+        .monitorForceAspectRatio = false,
+        .deviceOverrides = {},
     };
 
     if (!(std::filesystem::exists(get_application_config_path()) || std::filesystem::create_directory(get_application_config_path())))
@@ -582,9 +2090,44 @@ liberror::Result<void> safe_main(std::vector<std::string_view> const& arguments)
         fmt::println("A graphical xsetwacom wrapper for ease of use.");
         fmt::println("Usage:");
         fmt::println("  xsetwacomgui [OPTION...]");
+        fmt::println("  xsetwacomgui COMMAND [ARGUMENT...]");
         fmt::println("");
-        fmt::println("  --no-gui        Launches the program without the UI. This is intended for");
-        fmt::println("                  loading saved device settings on system boot.");
+        fmt::println("  --no-gui              Launches the program without the UI. This is intended for");
+        fmt::println("                        loading saved device settings on system boot.");
+        fmt::println("  --displays[=:0,:1]    Does what --no-gui does on every display given, or on every");
+        fmt::println("                        display found in /tmp/.X11-unix, all at the same time, and");
+        fmt::println("                        reports how each of them went as JSON.");
+        fmt::println("  --display=NAME        Talks to the named X display instead of $DISPLAY.");
+        fmt::println("  --device-settings=FILE");
+        fmt::println("                        Reads and saves the device settings in FILE instead of");
+        fmt::println("                        device.json.");
+        fmt::println("  --follow-focus        Applies the profile that the rules in profiles.json pick for");
+        fmt::println("                        the focused window, whenever the focus changes.");
+        fmt::println("  --headless-frames=N   Renders N frames of the UI without a window against fake");
+        fmt::println("                        devices and monitors, then reports the frame times.");
+        fmt::println("  --measure-input[=S]   Applies the saved device settings, records the stylus for S");
+        fmt::println("                        seconds (10 by default) and reports its report rate, jitter");
+        fmt::println("                        and latency as JSON.");
+        fmt::println("  --measure-device=NAME Measures the named XInput device instead of the stylus.");
+        fmt::println("  --mem-report          Prints how much memory each part of the program holds right");
+        fmt::println("                        before it exits.");
+        fmt::println("  --trace FILE          Writes a chrome trace of startup, backend calls and frames");
+        fmt::println("                        to FILE on exit.");
+        fmt::println("  --record=FILE         Records the input of every frame and the answers of the");
+        fmt::println("                        backend to FILE, to be replayed later.");
+        fmt::println("  --replay=FILE         Replays a recorded session without a window and compares its");
+        fmt::println("                        frame times with the recorded ones.");
+        fmt::println("  --software-renderer   Draws the UI on the CPU instead of through OpenGL, which is");
+        fmt::println("                        also done when no OpenGL context can be created.");
+        fmt::println("  --scenarios[=DIR]     Runs the UI scenarios in DIR (scenarios by default) against");
+        fmt::println("                        fake devices, compares their captures with the golden images");
+        fmt::println("                        and checks their frame times. --update-goldens rewrites the");
+        fmt::println("                        golden images instead of comparing against them.");
+        fmt::println("  --benchmark-curve-fit[=N]");
+        fmt::println("                        Fits the pressure curve to N (100 by default) synthetic");
+        fmt::println("                        calibrations and reports the fit times and errors as JSON.");
+        fmt::println("");
+        print_commands_help();
         return {};
     }
 
@@ -608,20 +2151,105 @@ liberror::Result<void> safe_main(std::vector<std::string_view> const& arguments)
         auto device  = devices.front();
         auto monitor = *std::ranges::find_if(monitors, &Monitor::primary);
 
-        TRY(set_settings_to_device(device, monitor, deviceSettings));
+        TRY(set_settings_to_tablet(find_tablet(tablets, device), monitor, deviceSettings));
 
         fmt::println("Device settings loaded successfully");
 
         return {};
     }
 
+    if (std::find(arguments.begin(), arguments.end(), "--follow-focus") != arguments.end())
+    {
+        if (devices.empty())
+        {
+            return liberror::make_error("Failed to load devices");
+        }
+
+        return follow_window_focus(find_tablet(tablets, devices.front()), monitors);
+    }
+
+    if (auto const measureInput = find_option(arguments, "--measure-input"); measureInput.has_value())
+    {
+        auto const seconds = measureInput->empty() ? 10 : TRY(parse_count(*measureInput));
+
+        std::string deviceName = devices.empty() ? "" : devices.front().name;
+        std::optional<OutputMapping> mapping {};
+
+        if (!devices.empty() && !monitors.empty() && std::filesystem::exists(DEVICE_SETTINGS_FILE) && load_device_settings(deviceSettings))
+        {
+            auto const& monitor = *std::ranges::find_if(monitors, &Monitor::primary);
+
+            TRY(set_settings_to_tablet(find_tablet(tablets, devices.front()), monitor, deviceSettings));
+
+            mapping = OutputMapping {
+                .deviceArea = deviceSettings.deviceArea,
+                .outputArea = {
+                    deviceSettings.monitorArea.offsetX + monitor.offsetX,
+                    deviceSettings.monitorArea.offsetY + monitor.offsetY,
+                    deviceSettings.monitorArea.width,
+                    deviceSettings.monitorArea.height,
+                },
+            };
+        }
+
+        if (deviceName.empty())
+        {
+            return liberror::make_error("Failed to load devices");
+        }
+
+        auto const capture = TRY(capture_input(deviceName, std::chrono::seconds(seconds)));
+        fmt::println("{}", analyse_input_capture(capture, mapping).dump(4));
+
+        return {};
+    }
+
     ApplicationSettings applicationSettings {
         .scale = 1.0,
-        .theme = ApplicationSettings::Theme::DARK,
+        .theme = "DARK",
         .language = ApplicationSettings::Language::EN_US,
         .font = "default",
     };
 
+    if (headlessFrames.has_value())
+    {
+        auto const frames = TRY(parse_count(*headlessFrames));
+
+        // the settings files are never read nor written here so that a run does not depend on, or clobber, the user configuration
+        deviceSettings = TRY(make_headless_device_settings(deviceSettings, devices, monitors));
+
+        auto const run = TRY(run_headless_frames(frames, { 800_scaled, 815_scaled }, push_headless_input, memoryReport, deviceSettings, devices, tablets, monitors, applicationSettings));
+
+        print_frame_statistics(compute_frame_statistics(run.samples), run.samples);
+
+        if (run.memoryReport.has_value())
+        {
+            fmt::println("");
+            print_memory_report(*run.memoryReport);
+        }
+
+        return {};
+    }
+
+    if (scenarioPath.has_value())
+    {
+        auto const scenario = TRY(load_scenario(*scenarioPath));
+        auto const goldens = find_option(arguments, "--goldens");
+        auto const updateGoldens = find_option(arguments, "--update-goldens").has_value();
+
+        deviceSettings = TRY(make_headless_device_settings(deviceSettings, devices, monitors));
+
+        return run_scenario(scenario, goldens.has_value() ? std::filesystem::path(*goldens) : std::filesystem::path(*scenarioPath).parent_path() / "golden", updateGoldens, deviceSettings, devices, tablets, monitors);
+    }
+
+    if (replayPath.has_value())
+    {
+        return replay_session(session, unrecordedCalls, memoryReport, deviceSettings, devices, tablets, monitors);
+    }
+
+    TraceSpan loadSettings { "startup::load_settings" };
+
+    the_default_area_cache().load(get_application_cache_path() / "default-areas.json");
+
     if (!std::filesystem::exists(APPLICATION_SETTINGS_FILE))
     {
         if (!save_application_settings(applicationSettings))
@@ -639,165 +2267,225 @@ liberror::Result<void> safe_main(std::vector<std::string_view> const& arguments)
         set_scale(applicationSettings.scale);
     }
 
+    if (recordPath.has_value())
+    {
+        session.applicationSettings = applicationSettings;
+
+        if (std::filesystem::exists(DEVICE_SETTINGS_FILE))
+        {
+            std::ifstream stream(DEVICE_SETTINGS_FILE);
+            session.deviceSettingsFile = std::string(std::istreambuf_iterator<char>(stream), {});
+        }
+    }
+
+    std::vector<bool> recordedKeysDown {};
+
+    loadSettings.end();
+
+    TraceSpan createWindow { "startup::create_window" };
+
     if (!glfwInit())
     {
         return liberror::make_error("Failed to initialize glfw");
     }
 
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+    // the software renderer is used when asked for, or when there is no opengl to be had
+    auto useSoftwareRenderer = find_option(arguments, "--software-renderer").has_value();
+    auto window = useSoftwareRenderer ? nullptr : create_window(true);
 
-#ifdef DEBUG
-    auto window = glfwCreateWindow(static_cast<int>(800_scaled), static_cast<int>(815_scaled), NAME " - DEBUG BUILD", nullptr, nullptr);
-#else
-    auto window = glfwCreateWindow(static_cast<int>(800_scaled), static_cast<int>(815_scaled), NAME, nullptr, nullptr);
-#endif
+    if (window == nullptr && !useSoftwareRenderer)
+    {
+        spdlog::warn("Failed to create an OpenGL context, falling back to the software renderer");
+        useSoftwareRenderer = true;
+    }
 
-    glfwMakeContextCurrent(window);
+    if (useSoftwareRenderer)
+    {
+        window = create_window(false);
+    }
 
-    IMGUI_CHECKVERSION();
-    ImGui::CreateContext();
-    ImGui_ImplGlfw_InitForOpenGL(window, true);
-    ImGui_ImplOpenGL3_Init("#version 130");
+    if (window == nullptr)
+    {
+        return liberror::make_error("Failed to create the window");
+    }
 
-    auto& io = ImGui::GetIO();
+    std::unique_ptr<SoftwareRenderer> softwareRenderer {};
 
-    io.IniFilename = nullptr;
-    io.LogFilename = nullptr;
+    if (useSoftwareRenderer)
+    {
+        softwareRenderer = TRY(SoftwareRenderer::open(window));
+        the_software_renderer() = softwareRenderer.get();
+        glfwSetWindowRefreshCallback(window, [] (GLFWwindow*) { the_software_renderer()->invalidate(); });
+    }
+    else
+    {
+        glfwMakeContextCurrent(window);
+    }
 
-    ImFont* font = nullptr;
+    float contentScale = get_window_content_scale(window);
+    glfwSetWindowUserPointer(window, &contentScale);
+    glfwSetWindowPosCallback(window, [] (GLFWwindow* movedWindow, int, int) {
+        *static_cast<float*>(glfwGetWindowUserPointer(movedWindow)) = get_window_content_scale(movedWindow);
+    });
+    glfwSetWindowContentScaleCallback(window, [] (GLFWwindow* scaledWindow, float, float) {
+        *static_cast<float*>(glfwGetWindowUserPointer(scaledWindow)) = get_window_content_scale(scaledWindow);
+    });
 
-    ImVector<ImWchar> ranges {};
-    ImFontGlyphRangesBuilder rangeBuilder {};
+    createWindow.end();
 
-    static const ImWchar rangesData[] =
-    {
-        0x0020, 0x00FF, // Basic Latin + Latin Supplement
-        0x0400, 0x052F, // Cyrillic + Cyrillic Supplement
-        0x2DE0, 0x2DFF, // Cyrillic Extended-A
-        0xA640, 0xA69F, // Cyrillic Extended-B
-        0,
-    };
+    TraceSpan initImGui { "startup::init_imgui" };
+
+    // counts what imgui holds for the memory report, the atlas below is allocated by imgui as well
+    install_imgui_allocation_counter();
+
+    // the context does not own the atlas, so that it can be replaced whenever the font or the scale change
+    set_scale(applicationSettings.scale * contentScale);
+    auto fontAtlas = build_font_atlas(applicationSettings.font, the_scale());
+
+    // the window was created before its monitor, and so its content scale, was known
+    glfwSetWindowSize(window, static_cast<int>(800_scaled), static_cast<int>(815_scaled));
+
+    auto fontAtlasFont = applicationSettings.font;
+    auto fontAtlasScale = the_scale();
+    FontAtlasBuilder fontAtlasBuilder {};
+
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext(fontAtlas.get());
 
-    rangeBuilder.AddRanges(rangesData);
-    rangeBuilder.BuildRanges(&ranges);
+    auto& io = ImGui::GetIO();
 
-    if (applicationSettings.font != "default")
+    if (softwareRenderer)
+    {
+        ImGui_ImplGlfw_InitForOther(window, true);
+        io.BackendRendererName = "xsetwacomgui_software";
+        io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+    }
+    else
     {
-        font = io.Fonts->AddFontFromFileTTF(applicationSettings.font.data(), 20_scaled, nullptr, ranges.Data);
+        ImGui_ImplGlfw_InitForOpenGL(window, true);
+        ImGui_ImplOpenGL3_Init("#version 130");
     }
 
+    // the software renderer keeps its own copy of the atlas, after which the pixels are cleared like they are for opengl
+    auto const upload_font_atlas = [&] {
+        if (!softwareRenderer) return;
+
+        unsigned char* pixels = nullptr;
+        int width = 0, height = 0;
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+        io.Fonts->SetTexID(create_texture(width, height, reinterpret_cast<uint32_t const*>(pixels)));
+    };
+
+    upload_font_atlas();
+
+    io.IniFilename = nullptr;
+    io.LogFilename = nullptr;
+
+    ImFont* font = io.Fonts->Fonts[0];
+
+    initImGui.end();
+
     while (!glfwWindowShouldClose(window))
     {
-        glClear(GL_COLOR_BUFFER_BIT);
+        TRACE_SCOPE("frame");
+
+        if (!softwareRenderer) glClear(GL_COLOR_BUFFER_BIT);
 
         if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         {
             break;
         }
 
-        if (applicationSettings.theme == ApplicationSettings::Theme::DARK)
+        // everything derived from the scale or the font is changed here, in between two frames
+        if (applicationSettings.scale * contentScale != the_scale())
         {
-            ImGui::StyleColorsDark();
+            set_scale(applicationSettings.scale * contentScale);
+            glfwSetWindowSize(window, static_cast<int>(800_scaled), static_cast<int>(815_scaled));
         }
-        else
+
+        if (fontAtlasFont != applicationSettings.font || fontAtlasScale != the_scale())
         {
-            ImGui::StyleColorsLight();
+            fontAtlasFont = applicationSettings.font;
+            fontAtlasScale = the_scale();
+            fontAtlasBuilder.request(fontAtlasFont, fontAtlasScale);
         }
 
-        ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplGlfw_NewFrame();
-        ImGui::NewFrame();
+        if (auto atlas = fontAtlasBuilder.take())
+        {
+            if (softwareRenderer) destroy_texture(io.Fonts->TexID); else ImGui_ImplOpenGL3_DestroyFontsTexture();
+            fontAtlas = std::move(atlas);
+            io.Fonts = fontAtlas.get();
+            font = io.Fonts->Fonts[0];
+            if (softwareRenderer) upload_font_atlas(); else ImGui_ImplOpenGL3_CreateFontsTexture();
+        }
+
+        if (!softwareRenderer) ImGui_ImplOpenGL3_NewFrame();
 
-        ImGui::PushFont(font);
+        // the renderer uploads the atlas on its first frame, after that the pixels are only dead weight
+        if (io.Fonts->TexPixelsAlpha8 || io.Fonts->TexPixelsRGBA32)
         {
-            int windowWidth, windowHeight;
-            glfwGetWindowSize(window, &windowWidth, &windowHeight);
-            ImGui::SetNextWindowPos({});
-            ImGui::SetNextWindowSize({ static_cast<float>(windowWidth), static_cast<float>(windowHeight) });
-            ImGui::Begin(NAME, nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoBringToFrontOnFocus | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_MenuBar);
-            ImGui::RenderToasts();
-            {
-                static bool isApplicationSettingsOpen = false;
-                static bool isGoddessOpen = false;
+            io.Fonts->ClearTexData();
+            set_memory_usage("font atlas", get_font_atlas_memory_usage(*io.Fonts));
+        }
 
-                if (ImGui::BeginMenuBar())
-                {
-                    if (ImGui::BeginMenu(TRY(Localisation::get(applicationSettings.language, Localisation::MenuBar_Settings))))
-                    {
-                        if (ImGui::MenuItem(TRY(Localisation::get(applicationSettings.language, Localisation::MenuBar_Settings_Application))))
-                        {
-                            isApplicationSettingsOpen = true;
-                        }
+        ImGui_ImplGlfw_NewFrame();
 
-                        ImGui::EndMenu();
-                    }
+        auto const allocations = get_imgui_allocation_count();
+        auto const heapAllocations = get_heap_allocation_count();
+        auto const begin = std::chrono::steady_clock::now();
 
-                    if (ImGui::BeginMenu(TRY(Localisation::get(applicationSettings.language, Localisation::MenuBar_Other))))
-                    {
-                        if (ImGui::MenuItem(TRY(Localisation::get(applicationSettings.language, Localisation::MenuBar_Other_Goddess))))
-                        {
-                            isGoddessOpen = true;
-                        }
+        ImGui::NewFrame();
 
-                        ImGui::EndMenu();
-                    }
+        // the queued characters are gone by the end of the frame, so the input is taken right away
+        std::optional<RecordedFrame> recordedFrame {};
+        if (recordPath.has_value()) recordedFrame = capture_frame_input(io, recordedKeysDown);
 
-                    ImGui::EndMenuBar();
-                }
+        int windowWidth, windowHeight;
+        glfwGetWindowSize(window, &windowWidth, &windowHeight);
+        TRY(render_frame({ static_cast<float>(windowWidth), static_cast<float>(windowHeight) }, font, deviceSettings, devices, tablets, monitors, applicationSettings));
 
-                if (isApplicationSettingsOpen)
-                {
-                    float applicationSettingsWidth = static_cast<float>(windowWidth)/1.5f, applicationSettingsHeight = static_cast<float>(windowHeight)/1.5f;
-                    ImGui::SetNextWindowSize({ applicationSettingsWidth, applicationSettingsHeight });
-                    ImGui::SetNextWindowPos({ (static_cast<float>(windowWidth) - applicationSettingsWidth)/2, (static_cast<float>(windowHeight) - applicationSettingsHeight)/2 });
-                    ImGui::Begin(
-                        TRY(Localisation::get(applicationSettings.language, Localisation::MenuBar_Settings_Application)),
-                        &isApplicationSettingsOpen,
-                        ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoSavedSettings
-                    );
-                    {
-                        render_settings_popup(applicationSettings);
-                    }
-                    ImGui::End();
-                }
+        ImGui::Render();
 
-                if (isGoddessOpen)
-                {
-                    float goddessWidth = static_cast<float>(windowWidth)/1.5f, goddessHeight = static_cast<float>(windowHeight)/1.5f;
-                    ImGui::SetNextWindowSize({ goddessWidth, goddessHeight });
-                    ImGui::SetNextWindowPos({ (static_cast<float>(windowWidth) - goddessWidth)/2, (static_cast<float>(windowHeight) - goddessHeight)/2 });
-                    ImGui::Begin(
-                        TRY(Localisation::get(applicationSettings.language, Localisation::MenuBar_Other_Goddess)),
-                        &isGoddessOpen,
-                        ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoSavedSettings
-                    );
-                    {
-                        render_goddess_popup();
-                    }
-                    ImGui::End();
-                }
+        lastFrameHeapAllocations = get_heap_allocation_count() - heapAllocations;
 
-                ImGui::BeginDisabled(devices.empty());
-                {
-                    TRY(render_window(deviceSettings, devices, monitors, applicationSettings));
-                }
-                ImGui::EndDisabled();
-            }
-            ImGui::End();
+        // timed the same way as a headless frame, so that a replay can be compared against it
+        if (recordedFrame.has_value())
+        {
+            recordedFrame->sample = { std::chrono::steady_clock::now() - begin, get_imgui_allocation_count() - allocations, 0 };
+            session.frames.push_back(std::move(*recordedFrame));
+            session.windowSize = { static_cast<float>(windowWidth), static_cast<float>(windowHeight) };
+            session.scale = the_scale();
+        }
+        // without a swap interval to wait on, the software renderer waits for input for at most a frame at 60 Hz
+        if (softwareRenderer)
+        {
+            TRY(softwareRenderer->render(*ImGui::GetDrawData()));
+            glfwWaitEventsTimeout(1.0 / 60.0);
+        }
+        else
+        {
+            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+            glfwSwapBuffers(window);
+            glfwPollEvents();
         }
-        ImGui::PopFont();
+    }
 
-        ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+    if (memoryReport)
+    {
+        print_memory_report(TRY(get_memory_report()));
+    }
+
+    if (recordPath.has_value())
+    {
+        TRY(save_session(*recordPath, session));
     }
 
-    ImGui_ImplOpenGL3_Shutdown();
+    if (!softwareRenderer) ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
+
+    the_software_renderer() = nullptr;
+    softwareRenderer.reset();
     glfwDestroyWindow(window);
 
     glfwTerminate();
@@ -811,7 +2499,38 @@ int main(int argc, char const** argv)
         std::span<char const*>(argv, size_t(argc))
             | std::views::transform([] (auto&& argument) { return std::string_view(argument); });
 
-    auto result = safe_main({ arguments.begin(), arguments.end() });
+    std::vector<std::string_view> options { arguments.begin(), arguments.end() };
+
+    // accepts both "--trace FILE" and "--trace=FILE", and takes them out of the arguments so that the
+    // commands do not mistake the file for one of their operands
+    if (auto trace = std::ranges::find_if(options, [] (auto option) { return option == "--trace" || option.starts_with("--trace="); }); trace != options.end())
+    {
+        auto tracePath = trace->substr(std::min(trace->size(), std::string_view("--trace=").size()));
+        auto last = std::next(trace);
+
+        if (*trace == "--trace" && last != options.end())
+        {
+            tracePath = *last;
+            last = std::next(last);
+        }
+
+        options.erase(trace, last);
+
+        if (tracePath.empty())
+        {
+            spdlog::error("Missing file for --trace");
+            return EXIT_FAILURE;
+        }
+
+        start_tracing(tracePath);
+    }
+
+    auto result = safe_main(options);
+
+    if (auto traced = stop_tracing(); !traced.has_value())
+    {
+        spdlog::error("{}", traced.error().message());
+    }
 
     if (!result.has_value())
     {
@@ -0,0 +1,78 @@
+#define IMGUI_DEFINE_MATH_OPERATORS
+#include "MapperModel.hpp"
+
+static bool is_same_area(libwacom::Area const& lhs, libwacom::Area const& rhs)
+{
+    return lhs.offsetX == rhs.offsetX && lhs.offsetY == rhs.offsetY && lhs.width == rhs.width && lhs.height == rhs.height;
+}
+
+void sync_mapper_model(MapperModel& model, libwacom::Area const& area, libwacom::Area const& defaultArea)
+{
+    if (is_same_area(model.area, area) && is_same_area(model.defaultArea, defaultArea)) return;
+
+    model.area = area;
+    model.defaultArea = defaultArea;
+    model.version += 1;
+
+    // without a default area there is nothing to be relative to, the whole of the mapper is shown
+    if (defaultArea.width <= 0 || defaultArea.height <= 0)
+    {
+        model.anchors[0] = { 0, 0 };
+        model.anchors[1] = { 0, 1 };
+        model.anchors[2] = { 1, 0 };
+        model.anchors[3] = { 1, 1 };
+        return;
+    }
+
+    auto const left = area.offsetX / defaultArea.width;
+    auto const top = area.offsetY / defaultArea.height;
+    auto const right = (area.offsetX + area.width) / defaultArea.width;
+    auto const bottom = (area.offsetY + area.height) / defaultArea.height;
+
+    model.anchors[0] = { left, top };
+    model.anchors[1] = { left, bottom };
+    model.anchors[2] = { right, top };
+    model.anchors[3] = { right, bottom };
+}
+
+libwacom::Area commit_mapper_model(MapperModel& model)
+{
+    auto const& anchors = model.anchors;
+    auto const& defaultArea = model.defaultArea;
+
+    model.area = {
+        .offsetX = anchors[0].x * defaultArea.width,
+        .offsetY = anchors[0].y * defaultArea.height,
+        .width   = (anchors[2].x - anchors[0].x) * defaultArea.width,
+        .height  = (anchors[3].y - anchors[2].y) * defaultArea.height,
+    };
+    model.version += 1;
+
+    return model.area;
+}
+
+void set_mapper_frame(MapperModel& model, ImRect const& frame)
+{
+    if (frame.Min.x == model.frame.Min.x && frame.Min.y == model.frame.Min.y && frame.Max.x == model.frame.Max.x && frame.Max.y == model.frame.Max.y) return;
+
+    model.frame = frame;
+    model.version += 1;
+}
+
+ImVec2 to_mapper_pixels(MapperModel const& model, ImVec2 anchor)
+{
+    return anchor * (model.frame.Max - model.frame.Min) + model.frame.Min;
+}
+
+void update_mapper_connection(MapperConnection& connection, MapperModel const& from, MapperModel const& to)
+{
+    if (connection.fromVersion == from.version && connection.toVersion == to.version) return;
+
+    for (size_t i = 0; i < connection.lines.size(); i += 1)
+    {
+        connection.lines[i] = { to_mapper_pixels(from, from.anchors[i]), to_mapper_pixels(to, to.anchors[i]) };
+    }
+
+    connection.fromVersion = from.version;
+    connection.toVersion = to.version;
+}
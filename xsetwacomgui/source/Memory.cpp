@@ -0,0 +1,85 @@
+#include "Memory.hpp"
+
+#include "Profiling.hpp"
+
+#include <fmt/format.h>
+
+#include <fstream>
+#include <limits>
+#include <map>
+#include <mutex>
+
+struct MemoryAccounting
+{
+    std::mutex mutex;
+    std::map<std::string, MemoryUsage, std::less<>> subsystems;
+};
+
+static MemoryAccounting& the_memory_accounting()
+{
+    static MemoryAccounting accounting {};
+    return accounting;
+}
+
+void set_memory_usage(std::string_view subsystem, MemoryUsage usage)
+{
+    auto& accounting = the_memory_accounting();
+    std::lock_guard lock { accounting.mutex };
+
+    if (auto entry = accounting.subsystems.find(subsystem); entry != accounting.subsystems.end())
+    {
+        entry->second = usage;
+    }
+    else
+    {
+        accounting.subsystems.emplace(std::string(subsystem), usage);
+    }
+}
+
+liberror::Result<MemoryReport> get_memory_report()
+{
+    MemoryReport report {};
+
+    // the kernel reports these in kB
+    std::ifstream status("/proc/self/status");
+    if (!status.is_open())
+        return liberror::make_error("Failed to open /proc/self/status");
+
+    std::string key {};
+    size_t value = 0;
+    while (status >> key)
+    {
+        if (key == "VmRSS:" && status >> value) report.residentBytes = value * 1024;
+        else if (key == "RssAnon:" && status >> value) report.anonymousBytes = value * 1024;
+        else if (key == "RssFile:" && status >> value) report.fileBytes = value * 1024;
+        status.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+
+    auto& accounting = the_memory_accounting();
+    std::lock_guard lock { accounting.mutex };
+
+    report.subsystems.assign(accounting.subsystems.begin(), accounting.subsystems.end());
+    report.subsystems.emplace_back("imgui", MemoryUsage { get_imgui_allocated_bytes(), 0 });
+
+    return report;
+}
+
+void print_memory_report(MemoryReport const& report)
+{
+    auto const kib = [] (size_t bytes) { return static_cast<double>(bytes) / 1024.0; };
+
+    fmt::println("resident {:>10.1f} KiB (anonymous {:.1f} KiB, file {:.1f} KiB)", kib(report.residentBytes), kib(report.anonymousBytes), kib(report.fileBytes));
+    fmt::println("");
+    fmt::println("{:<20} {:>14} {:>14}", "subsystem", "cpu", "gpu");
+
+    MemoryUsage total {};
+
+    for (auto const& [subsystem, usage] : report.subsystems)
+    {
+        fmt::println("{:<20} {:>10.1f} KiB {:>10.1f} KiB", subsystem, kib(usage.cpu), kib(usage.gpu));
+        total.cpu += usage.cpu;
+        total.gpu += usage.gpu;
+    }
+
+    fmt::println("{:<20} {:>10.1f} KiB {:>10.1f} KiB", "total", kib(total.cpu), kib(total.gpu));
+}
@@ -1,30 +1,28 @@
 #include "Monitor.hpp"
 
+#include "Process.hpp"
+
 #include <liberror/Try.hpp>
 #include <fmt/format.h>
 
 #include <cstdlib>
 #include <regex>
+#include <utility>
 
 namespace xrandr {
 
-liberror::Result<std::string> execute(std::string_view command)
+liberror::Result<std::string> execute(std::vector<std::string> arguments)
 {
-    std::string output {};
-    auto const fd = popen(fmt::format("xrandr {}", command).data(), "r");
-    if (fd == nullptr)
-        return liberror::make_error("File descriptor for xrandr command returned as nullptr");
+    arguments.insert(arguments.begin(), "xrandr");
+
+    auto result = TRY(run_process(arguments));
 
-    while (true)
+    if (result.exitStatus != 0)
     {
-        std::array<char, 512> buffer {0};
-        if (fgets(buffer.data(), buffer.size(), fd) == nullptr) break;
-        output.append(buffer.data());
+        return liberror::make_error("xrandr exited with status {}: {}", result.exitStatus, result.error);
     }
 
-    pclose(fd);
-
-    return output;
+    return std::move(result.output);
 }
 
 }
@@ -33,7 +31,7 @@ liberror::Result<std::vector<Monitor>> get_available_monitors()
 {
     std::vector<Monitor> monitors {};
 
-    auto output = TRY(xrandr::execute("--listactivemonitors"));
+    auto output = TRY(xrandr::execute({ "--listactivemonitors" }));
 
     std::regex pattern(R"((\d+):\s*\+(\*?)([A-Za-z0-9\-]+)\s(\d+)\/\d+x(\d+)\/\d+\+(\d+)\+(\d+))");
     std::sregex_iterator iterator(output.begin(), output.end(), pattern);
@@ -0,0 +1,47 @@
+#include "Options.hpp"
+
+#include <charconv>
+
+std::optional<std::string_view> find_option(std::vector<std::string_view> const& arguments, std::string_view name)
+{
+    for (auto argument : arguments)
+    {
+        if (!argument.starts_with(name)) continue;
+        if (argument.size() == name.size()) return std::string_view {};
+        if (argument[name.size()] == '=') return argument.substr(name.size() + 1);
+    }
+
+    return std::nullopt;
+}
+
+liberror::Result<size_t> parse_count(std::string_view value)
+{
+    size_t count = 0;
+
+    if (std::from_chars(value.data(), value.data() + value.size(), count).ec != std::errc {} || count == 0)
+    {
+        return liberror::make_error("Invalid count: {}", value);
+    }
+
+    return count;
+}
+
+liberror::Result<void> parse_numbers(std::string_view value, std::span<float> output)
+{
+    auto begin = value.data();
+    auto const end = value.data() + value.size();
+
+    for (size_t i = 0; i < output.size(); i += 1)
+    {
+        auto const [next, error] = std::from_chars(begin, end, output[i]);
+
+        if (error != std::errc {} || (i + 1 < output.size() ? next == end || *next != ',' : next != end))
+        {
+            return liberror::make_error("Expected {} comma separated numbers: {}", output.size(), value);
+        }
+
+        begin = next + 1;
+    }
+
+    return {};
+}
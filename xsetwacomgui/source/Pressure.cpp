@@ -0,0 +1,59 @@
+#include "Pressure.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+std::vector<float> make_pressure_curve_table(libwacom::Pressure const& pressure, size_t size)
+{
+    static constexpr size_t SEGMENTS_PER_ENTRY = 4;
+
+    std::vector<float> table(size);
+
+    auto const point = [&] (float t) {
+        auto const u = 1 - t;
+        return std::pair {
+            std::clamp(3*u*u*t*pressure.minX + 3*u*t*t*pressure.maxX + t*t*t, 0.f, 1.f),
+            std::clamp(3*u*u*t*pressure.minY + 3*u*t*t*pressure.maxY + t*t*t, 0.f, 1.f),
+        };
+    };
+
+    auto const last = static_cast<float>(size - 1);
+    auto const segments = size * SEGMENTS_PER_ENTRY;
+    auto [x0, y0] = point(0);
+
+    for (size_t i = 1; i <= segments; i += 1)
+    {
+        auto const [x1, y1] = point(static_cast<float>(i) / static_cast<float>(segments));
+
+        // every entry whose abscissa falls inside this segment is linearly interpolated from its ends
+        for (auto j = static_cast<size_t>(std::ceil(x0 * last)); j <= static_cast<size_t>(std::floor(x1 * last)); j += 1)
+        {
+            auto const x = static_cast<float>(j) / last;
+            table[j] = x1 == x0 ? y1 : y0 + (y1 - y0) * (x - x0) / (x1 - x0);
+        }
+
+        x0 = x1;
+        y0 = y1;
+    }
+
+    return table;
+}
+
+float evaluate_pressure_curve(std::span<float const> table, float pressure)
+{
+    auto const index = std::clamp(pressure, 0.f, 1.f) * static_cast<float>(table.size() - 1);
+    return table[static_cast<size_t>(std::lround(index))];
+}
+
+void evaluate_pressure_curve(std::span<float const> table, std::span<float const> pressure, std::span<float> output)
+{
+    auto const last = static_cast<float>(table.size() - 1);
+    auto const count = std::min(pressure.size(), output.size());
+
+    // adding a half and truncating rounds like lround does, the index is never negative
+    for (size_t i = 0; i < count; i += 1)
+    {
+        output[i] = table[static_cast<size_t>(std::clamp(pressure[i], 0.f, 1.f) * last + 0.5f)];
+    }
+}
@@ -0,0 +1,366 @@
+#include "PressureFit.hpp"
+
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numbers>
+#include <numeric>
+#include <random>
+#include <vector>
+
+// samples are gathered into bins so that the cost of an iteration does not grow with the length of the strokes
+static constexpr size_t BINS = 64;
+static constexpr size_t PARAMETERS = 4;
+
+// a stroke only counts once it is past its first and before its last fifth
+static constexpr double TRIMMED = 0.2;
+
+// keeps the fit close to a straight line where the strokes say nothing about the curve
+static constexpr double REGULARISATION = 0.05;
+
+static constexpr size_t MAX_ITERATIONS = 100;
+
+// the fit is done once an iteration takes less than this off the cost, relative to it
+static constexpr double TOLERANCE = 1e-6;
+
+struct Residual
+{
+    double pressure;
+    double target;
+    double weight;
+};
+
+using Parameters = std::array<double, PARAMETERS>;
+
+static libwacom::Pressure to_curve(Parameters const& parameters)
+{
+    return {
+        static_cast<float>(parameters[0]),
+        static_cast<float>(parameters[1]),
+        static_cast<float>(parameters[2]),
+        static_cast<float>(parameters[3]),
+    };
+}
+
+static double bezier(double t, double first, double second)
+{
+    auto const u = 1 - t;
+    return 3*u*u*t*first + 3*u*t*t*second + t*t*t;
+}
+
+// x(t) never decreases while both control points lie inside the unit square
+static double solve_bezier(double value, double first, double second)
+{
+    double low = 0, high = 1;
+
+    for (size_t i = 0; i < 32; i += 1)
+    {
+        auto const middle = (low + high) / 2;
+        (bezier(middle, first, second) < value ? low : high) = middle;
+    }
+
+    return (low + high) / 2;
+}
+
+static std::vector<Residual> make_residuals(std::span<Stroke const, CALIBRATION_TARGETS.size()> strokes)
+{
+    std::vector<Residual> residuals {};
+
+    for (size_t target = 0; target < strokes.size(); target += 1)
+    {
+        auto const& pressure = strokes[target].pressure;
+        std::array<double, BINS> counts {};
+        double total = 0;
+
+        // every run of samples between the pen landing and lifting is a stroke of its own
+        for (size_t begin = 0; begin < pressure.size();)
+        {
+            if (pressure[begin] == 0) { begin += 1; continue; }
+
+            auto end = begin;
+            while (end < pressure.size() && pressure[end] != 0) end += 1;
+
+            auto const trim = static_cast<size_t>(static_cast<double>(end - begin) * TRIMMED);
+            for (auto i = begin + trim; i < end - trim; i += 1)
+            {
+                counts[std::min(BINS - 1, static_cast<size_t>(pressure[i] * BINS))] += 1;
+                total += 1;
+            }
+
+            begin = end;
+        }
+
+        if (total == 0) continue;
+
+        // every target weighs the same however many samples were drawn for it
+        for (size_t bin = 0; bin < BINS; bin += 1)
+        {
+            if (counts[bin] == 0) continue;
+            residuals.push_back({ (static_cast<double>(bin) + 0.5) / BINS, CALIBRATION_TARGETS[target], counts[bin] / total });
+        }
+    }
+
+    return residuals;
+}
+
+// the weighted residuals of every bin followed by the pull towards the straight line
+static void evaluate_residuals(std::span<Residual const> residuals, Parameters const& parameters, std::span<double> output)
+{
+    auto const curve = to_curve(parameters);
+
+    for (size_t i = 0; i < residuals.size(); i += 1)
+    {
+        output[i] = std::sqrt(residuals[i].weight) * (evaluate_pressure_bezier(curve, residuals[i].pressure) - residuals[i].target);
+    }
+
+    static constexpr Parameters LINEAR { 0, 0, 1, 1 };
+    for (size_t i = 0; i < PARAMETERS; i += 1)
+    {
+        output[residuals.size() + i] = REGULARISATION * (parameters[i] - LINEAR[i]);
+    }
+}
+
+static double sum_of_squares(std::span<double const> values)
+{
+    double sum = 0;
+    for (auto value : values) sum += value * value;
+    return sum;
+}
+
+// gaussian elimination with partial pivoting, the system is always four by four
+static bool solve(std::array<std::array<double, PARAMETERS>, PARAMETERS> matrix, Parameters& vector)
+{
+    for (size_t column = 0; column < PARAMETERS; column += 1)
+    {
+        auto pivot = column;
+        for (auto row = column + 1; row < PARAMETERS; row += 1)
+        {
+            if (std::abs(matrix[row][column]) > std::abs(matrix[pivot][column])) pivot = row;
+        }
+
+        if (std::abs(matrix[pivot][column]) < 1e-12) return false;
+
+        std::swap(matrix[column], matrix[pivot]);
+        std::swap(vector[column], vector[pivot]);
+
+        for (auto row = column + 1; row < PARAMETERS; row += 1)
+        {
+            auto const factor = matrix[row][column] / matrix[column][column];
+            for (auto k = column; k < PARAMETERS; k += 1) matrix[row][k] -= factor * matrix[column][k];
+            vector[row] -= factor * vector[column];
+        }
+    }
+
+    for (auto column = PARAMETERS; column-- > 0;)
+    {
+        for (auto k = column + 1; k < PARAMETERS; k += 1) vector[column] -= matrix[column][k] * vector[k];
+        vector[column] /= matrix[column][column];
+    }
+
+    return true;
+}
+
+double evaluate_pressure_bezier(libwacom::Pressure const& curve, double pressure)
+{
+    auto const t = solve_bezier(std::clamp(pressure, 0.0, 1.0), curve.minX, curve.maxX);
+    return std::clamp(bezier(t, curve.minY, curve.maxY), 0.0, 1.0);
+}
+
+liberror::Result<PressureFit> fit_pressure_curve(std::span<Stroke const, CALIBRATION_TARGETS.size()> strokes, libwacom::Pressure const& initial)
+{
+    TraceSpan span { "fit_pressure_curve" };
+
+    auto const residuals = make_residuals(strokes);
+    if (residuals.empty())
+        return liberror::make_error("None of the calibration strokes touched the tablet");
+
+    auto const count = residuals.size() + PARAMETERS;
+    std::vector<double> current(count), candidate(count);
+    std::vector<std::array<double, PARAMETERS>> jacobian(count);
+
+    Parameters parameters {
+        std::clamp<double>(initial.minX, 0, 1),
+        std::clamp<double>(initial.minY, 0, 1),
+        std::clamp<double>(initial.maxX, 0, 1),
+        std::clamp<double>(initial.maxY, 0, 1),
+    };
+
+    evaluate_residuals(residuals, parameters, current);
+    auto cost = sum_of_squares(current);
+    auto damping = 1e-3;
+    size_t iteration = 0;
+
+    for (; iteration < MAX_ITERATIONS; iteration += 1)
+    {
+        // central differences, stepping back inside the square when a control point sits on its edge
+        static constexpr double STEP = 1e-4;
+        for (size_t parameter = 0; parameter < PARAMETERS; parameter += 1)
+        {
+            auto forward = parameters, backward = parameters;
+            forward[parameter] = std::min(1.0, parameters[parameter] + STEP);
+            backward[parameter] = std::max(0.0, parameters[parameter] - STEP);
+
+            evaluate_residuals(residuals, forward, candidate);
+            for (size_t i = 0; i < count; i += 1) jacobian[i][parameter] = candidate[i];
+            evaluate_residuals(residuals, backward, candidate);
+            for (size_t i = 0; i < count; i += 1) jacobian[i][parameter] = (jacobian[i][parameter] - candidate[i]) / (forward[parameter] - backward[parameter]);
+        }
+
+        std::array<std::array<double, PARAMETERS>, PARAMETERS> normal {};
+        Parameters gradient {};
+        for (size_t i = 0; i < count; i += 1)
+        {
+            for (size_t row = 0; row < PARAMETERS; row += 1)
+            {
+                gradient[row] -= jacobian[i][row] * current[i];
+                for (size_t column = 0; column < PARAMETERS; column += 1) normal[row][column] += jacobian[i][row] * jacobian[i][column];
+            }
+        }
+
+        // a control point held on the edge of the square by the clamp stays there for this iteration, otherwise
+        // the step keeps spending itself on a direction that is clamped away and the fit crawls along the edge
+        for (size_t k = 0; k < PARAMETERS; k += 1)
+        {
+            if ((parameters[k] > 0 || gradient[k] >= 0) && (parameters[k] < 1 || gradient[k] <= 0)) continue;
+
+            gradient[k] = 0;
+            for (size_t other = 0; other < PARAMETERS; other += 1) normal[k][other] = normal[other][k] = 0;
+            normal[k][k] = 1;
+        }
+
+        auto improved = false;
+
+        // the damping grows until a step lowers the cost, the control points are kept inside the square
+        while (!improved && damping < 1e8)
+        {
+            auto damped = normal;
+            for (size_t k = 0; k < PARAMETERS; k += 1) damped[k][k] += damping * std::max(normal[k][k], 1e-9);
+
+            auto step = gradient;
+            if (!solve(damped, step)) { damping *= 10; continue; }
+
+            Parameters next {};
+            for (size_t k = 0; k < PARAMETERS; k += 1) next[k] = std::clamp(parameters[k] + step[k], 0.0, 1.0);
+
+            evaluate_residuals(residuals, next, candidate);
+            auto const nextCost = sum_of_squares(candidate);
+
+            if (nextCost < cost)
+            {
+                improved = cost - nextCost > TOLERANCE * cost;
+                parameters = next;
+                std::swap(current, candidate);
+                cost = nextCost;
+                damping = std::max(damping / 10, 1e-9);
+                if (!improved) damping = 1e8;
+            }
+            else
+            {
+                damping *= 10;
+            }
+        }
+
+        if (!improved) break;
+    }
+
+    // the error is reported without the regularisation, as the distance from the targets alone
+    double error = 0;
+    auto const curve = to_curve(parameters);
+    for (auto const& residual : residuals)
+    {
+        auto const distance = evaluate_pressure_bezier(curve, residual.pressure) - residual.target;
+        error += residual.weight * distance * distance;
+    }
+
+    return PressureFit { curve, std::sqrt(error / static_cast<double>(strokes.size())), iteration };
+}
+
+std::array<Stroke, CALIBRATION_TARGETS.size()> make_synthetic_calibration(libwacom::Pressure const& hand, uint32_t seed)
+{
+    static constexpr size_t STROKES = 5;
+    static constexpr size_t SAMPLES = 400;
+    static constexpr float RATE = 200; // reports per second
+
+    std::mt19937 generator { seed };
+    std::normal_distribution<float> wobble { 0.f, 0.03f };
+    std::array<Stroke, CALIBRATION_TARGETS.size()> calibration {};
+
+    for (size_t target = 0; target < CALIBRATION_TARGETS.size(); target += 1)
+    {
+        // the raw pressure this hand needs for the curve to give the target
+        auto const t = solve_bezier(CALIBRATION_TARGETS[target], hand.minY, hand.maxY);
+        auto const raw = static_cast<float>(bezier(t, hand.minX, hand.maxX));
+
+        auto& stroke = calibration[target];
+        auto time = 0.f;
+
+        for (size_t index = 0; index < STROKES; index += 1)
+        {
+            for (size_t sample = 0; sample < SAMPLES; sample += 1)
+            {
+                // the pressure ramps up as the pen lands and back down as it lifts
+                auto const progress = static_cast<float>(sample) / static_cast<float>(SAMPLES - 1);
+                auto const envelope = std::sin(progress * std::numbers::pi_v<float>);
+                auto const pressure = std::clamp(raw * std::min(1.f, envelope * 3) + wobble(generator), 0.001f, 1.f);
+
+                stroke.push(time, progress, static_cast<float>(index) / STROKES, pressure);
+                time += 1 / RATE;
+            }
+
+            stroke.push(time, 1, static_cast<float>(index) / STROKES, 0);
+            time += 0.25f;
+        }
+    }
+
+    return calibration;
+}
+
+static nlohmann::ordered_json summarise(std::vector<double> values)
+{
+    std::ranges::sort(values);
+    auto const percentile = [&] (size_t p) { return values.at((values.size() - 1) * p / 100); };
+
+    return {
+        { "mean", std::accumulate(values.begin(), values.end(), 0.0) / static_cast<double>(values.size()) },
+        { "p50", percentile(50) },
+        { "p99", percentile(99) },
+        { "max", values.back() },
+    };
+}
+
+nlohmann::ordered_json benchmark_pressure_fit(size_t runs)
+{
+    std::mt19937 generator { 0 };
+    std::uniform_real_distribution<float> control { 0.f, 1.f };
+
+    std::vector<double> durations {}, iterations {}, errors {};
+    size_t failures = 0;
+
+    for (size_t run = 0; run < runs; run += 1)
+    {
+        libwacom::Pressure const hand { control(generator), control(generator), control(generator), control(generator) };
+        auto const calibration = make_synthetic_calibration(hand, static_cast<uint32_t>(run));
+
+        auto const start = std::chrono::steady_clock::now();
+        auto const fit = fit_pressure_curve(calibration, { 0, 0, 1, 1 });
+        auto const end = std::chrono::steady_clock::now();
+
+        if (!fit.has_value()) { failures += 1; continue; }
+
+        durations.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+        iterations.push_back(static_cast<double>(fit->iterations));
+        errors.push_back(fit->error);
+    }
+
+    if (durations.empty()) return { { "runs", runs }, { "failures", failures } };
+
+    return {
+        { "runs", runs },
+        { "failures", failures },
+        { "fitUs", summarise(durations) },
+        { "iterations", summarise(iterations) },
+        { "error", summarise(errors) },
+    };
+}
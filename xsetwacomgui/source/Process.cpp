@@ -0,0 +1,180 @@
+#include "Process.hpp"
+
+#include "Trace.hpp"
+
+#include <fmt/format.h>
+#include <fmt/ranges.h>
+
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <future>
+
+extern char** environ;
+
+namespace {
+
+class Pipe
+{
+public:
+    std::array<int, 2> fds { -1, -1 };
+
+    Pipe() = default;
+    ~Pipe() { close_read(); close_write(); }
+
+    Pipe(Pipe const&) = delete;
+    Pipe& operator=(Pipe const&) = delete;
+
+    bool open() { return pipe2(fds.data(), O_CLOEXEC) == 0; }
+    void close_read() { if (fds[0] != -1) { close(fds[0]); fds[0] = -1; } }
+    void close_write() { if (fds[1] != -1) { close(fds[1]); fds[1] = -1; } }
+};
+
+constexpr size_t READ_CHUNK_SIZE = 64 * 1024;
+constexpr auto STOP_POLL_INTERVAL = std::chrono::milliseconds(50);
+
+// reads whatever is available into the back of the buffer, returns false once the pipe is closed
+bool drain(int fd, std::string& buffer)
+{
+    auto const size = buffer.size();
+    buffer.resize(size + READ_CHUNK_SIZE);
+
+    auto const count = read(fd, buffer.data() + size, READ_CHUNK_SIZE);
+    buffer.resize(size + static_cast<size_t>(std::max<ssize_t>(count, 0)));
+
+    return count > 0 || (count == -1 && (errno == EINTR || errno == EAGAIN));
+}
+
+int decode_wait_status(int status)
+{
+    if (WIFEXITED(status)) return WEXITSTATUS(status);
+    if (WIFSIGNALED(status)) return 128 + WTERMSIG(status);
+    return -1;
+}
+
+}
+
+liberror::Result<ProcessResult> run_process(std::vector<std::string> const& argv, ProcessOptions const& options)
+{
+    TraceSpan span { "run_process" };
+    span.argument("argv", fmt::format("{}", fmt::join(argv, " ")));
+
+    if (argv.empty())
+    {
+        return liberror::make_error("Cannot run an empty command");
+    }
+
+    Pipe output {}, error {};
+
+    if (!output.open() || !error.open())
+    {
+        return liberror::make_error("Failed to create pipes for {}: {}", argv.front(), std::strerror(errno));
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, output.fds[1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, error.fds[1], STDERR_FILENO);
+
+    std::vector<char*> arguments {};
+    for (auto const& argument : argv) arguments.push_back(const_cast<char*>(argument.data()));
+    arguments.push_back(nullptr);
+
+    pid_t pid = 0;
+    auto const start = std::chrono::steady_clock::now();
+    auto const spawned = posix_spawnp(&pid, arguments.front(), &actions, nullptr, arguments.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+
+    if (spawned != 0)
+    {
+        span.argument("status", std::strerror(spawned));
+        return liberror::make_error("Failed to run {}: {}", argv.front(), std::strerror(spawned));
+    }
+
+    output.close_write();
+    error.close_write();
+
+    ProcessResult result {};
+
+    auto const deadline = std::chrono::steady_clock::now() + options.timeout;
+    bool outputOpen = true, errorOpen = true;
+    bool expired = false;
+
+    while (outputOpen || errorOpen)
+    {
+        auto const now = std::chrono::steady_clock::now();
+
+        if (now >= deadline || options.stopToken.stop_requested())
+        {
+            expired = true;
+            break;
+        }
+
+        // a stop can only be noticed in between two polls, so they are kept short when one is possible
+        auto wait = std::chrono::ceil<std::chrono::milliseconds>(deadline - now);
+        if (options.stopToken.stop_possible()) wait = std::min(wait, STOP_POLL_INTERVAL);
+
+        std::array<pollfd, 2> fds {{
+            { .fd = outputOpen ? output.fds[0] : -1, .events = POLLIN, .revents = 0 },
+            { .fd = errorOpen ? error.fds[0] : -1, .events = POLLIN, .revents = 0 },
+        }};
+
+        if (poll(fds.data(), fds.size(), static_cast<int>(wait.count())) == -1 && errno != EINTR)
+        {
+            expired = true;
+            break;
+        }
+
+        if (fds[0].revents != 0) outputOpen = drain(output.fds[0], result.output);
+        if (fds[1].revents != 0) errorOpen = drain(error.fds[0], result.error);
+    }
+
+    if (expired)
+    {
+        kill(pid, SIGKILL);
+    }
+
+    int status = 0;
+    while (waitpid(pid, &status, 0) == -1 && errno == EINTR);
+
+    if (expired)
+    {
+        span.argument("status", "killed");
+        return liberror::make_error("{} did not finish in time and was killed", argv.front());
+    }
+
+    result.exitStatus = decode_wait_status(status);
+    result.duration = std::chrono::steady_clock::now() - start;
+    span.argument("status", std::to_string(result.exitStatus));
+
+    return result;
+}
+
+std::vector<liberror::Result<ProcessResult>> run_processes(std::vector<std::vector<std::string>> const& commands, ProcessOptions const& options)
+{
+    std::vector<std::future<liberror::Result<ProcessResult>>> pending {};
+    pending.reserve(commands.size());
+
+    for (auto const& command : commands)
+    {
+        pending.push_back(std::async(std::launch::async, [&command, &options] { return run_process(command, options); }));
+    }
+
+    std::vector<liberror::Result<ProcessResult>> results {};
+    results.reserve(commands.size());
+
+    for (auto& future : pending)
+    {
+        results.push_back(future.get());
+    }
+
+    return results;
+}
@@ -0,0 +1,97 @@
+#include "Profiles.hpp"
+
+#include "Settings.hpp"
+#include "Trace.hpp"
+
+#include <liberror/Try.hpp>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+
+static std::string to_lowercase(std::string value)
+{
+    std::ranges::transform(value, value.begin(), [] (unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return value;
+}
+
+// the default profile, when the rules do not name one, is whatever the gui last saved
+static std::filesystem::path get_profile_file(std::string const& name)
+{
+    return name == "default" ? DEVICE_SETTINGS_FILE : PROFILES_PATH / (name + ".json");
+}
+
+static liberror::Result<size_t> add_profile(ProfileRules& rules, std::string const& name, Tablet const& tablet, std::vector<Monitor> const& monitors)
+{
+    auto const profile = std::ranges::find(rules.profiles, name, &Profile::name);
+    if (profile != rules.profiles.end()) return static_cast<size_t>(profile - rules.profiles.begin());
+
+    auto const file = get_profile_file(name);
+
+    DeviceSettings settings {};
+    if (!std::filesystem::exists(file) || !load_device_settings(settings, file))
+        return liberror::make_error("Failed to load the profile \"{}\" from {}", name, file.string());
+
+    // the output mapping is relative to the monitor the settings were made for
+    auto monitor = std::ranges::find(monitors, settings.monitorName, &Monitor::name);
+    if (monitor == monitors.end()) monitor = std::ranges::find_if(monitors, &Monitor::primary);
+    if (monitor == monitors.end())
+        return liberror::make_error("Failed to load monitors");
+
+    rules.profiles.push_back({ name, get_tablet_state(tablet, *monitor, settings) });
+
+    return rules.profiles.size() - 1;
+}
+
+liberror::Result<ProfileRules> compile_profile_rules(std::filesystem::path const& file, Tablet const& tablet, std::vector<Monitor> const& monitors)
+{
+    TRACE_SCOPE("compile_profile_rules");
+
+    std::ifstream stream(file);
+    if (!stream.is_open())
+        return liberror::make_error("Failed to open the profile rules {}", file.string());
+
+    std::stringstream content;
+    content << stream.rdbuf();
+
+    nlohmann::json json {};
+
+    try
+    {
+        json = nlohmann::json::parse(content.str());
+    }
+    catch (std::exception const& error)
+    {
+        return liberror::make_error("Failed to parse the profile rules {}: {}", file.string(), error.what());
+    }
+
+    ProfileRules rules {};
+    rules.fallback = TRY(add_profile(rules, json.value("default", "default"), tablet, monitors));
+
+    for (auto const& rule : json.value("rules", nlohmann::json::array()))
+    {
+        if (!rule.contains("windowClass") || !rule.contains("profile"))
+            return liberror::make_error("Every profile rule needs a windowClass and a profile");
+
+        auto const windowClass = to_lowercase(rule["windowClass"].get<std::string>());
+        auto const profile = TRY(add_profile(rules, rule["profile"].get<std::string>(), tablet, monitors));
+
+        // the first rule for a class wins, as it would reading the file top to bottom
+        rules.rules.emplace(windowClass, profile);
+    }
+
+    return rules;
+}
+
+Profile const& match_profile(ProfileRules const& rules, WindowClass const& windowClass)
+{
+    for (auto const& name : { windowClass.name, windowClass.instance })
+    {
+        if (name.empty()) continue;
+        if (auto const rule = rules.rules.find(to_lowercase(name)); rule != rules.rules.end()) return rules.profiles[rule->second];
+    }
+
+    return rules.profiles[rules.fallback];
+}
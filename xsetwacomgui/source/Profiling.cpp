@@ -0,0 +1,166 @@
+#include "Profiling.hpp"
+
+#include <imgui/imgui.hpp>
+#include <fmt/format.h>
+
+#include <malloc.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <numeric>
+#include <ranges>
+#include <vector>
+
+#ifdef COUNT_ALLOCATIONS
+static std::atomic<size_t> heapAllocationCount = 0;
+
+static void* allocate(std::size_t size, std::align_val_t alignment)
+{
+    heapAllocationCount.fetch_add(1, std::memory_order_relaxed);
+
+    auto const bytes = std::max<std::size_t>(size, 1);
+    auto const align = static_cast<std::size_t>(alignment);
+
+    return align <= alignof(std::max_align_t) ? std::malloc(bytes) : std::aligned_alloc(align, (bytes + align - 1) / align * align);
+}
+
+void* operator new(std::size_t size)
+{
+    if (auto pointer = allocate(size, std::align_val_t { alignof(std::max_align_t) })) return pointer;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    if (auto pointer = allocate(size, alignment)) return pointer;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::nothrow_t const&) noexcept { return allocate(size, std::align_val_t { alignof(std::max_align_t) }); }
+void* operator new(std::size_t size, std::align_val_t alignment, std::nothrow_t const&) noexcept { return allocate(size, alignment); }
+void* operator new[](std::size_t size) { return ::operator new(size); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return ::operator new(size, alignment); }
+void* operator new[](std::size_t size, std::nothrow_t const&) noexcept { return allocate(size, std::align_val_t { alignof(std::max_align_t) }); }
+void* operator new[](std::size_t size, std::align_val_t alignment, std::nothrow_t const&) noexcept { return allocate(size, alignment); }
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept { std::free(pointer); }
+#endif
+
+size_t get_heap_allocation_count()
+{
+#ifdef COUNT_ALLOCATIONS
+    return heapAllocationCount.load(std::memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
+
+// atlases are built on a worker thread, so imgui may allocate from more than one thread
+static std::atomic<size_t> imguiAllocationCount = 0;
+static std::atomic<size_t> imguiAllocatedBytes = 0;
+
+void install_imgui_allocation_counter()
+{
+    ImGui::SetAllocatorFunctions(
+        [] (size_t size, void*) {
+            auto pointer = std::malloc(size);
+            imguiAllocationCount.fetch_add(1, std::memory_order_relaxed);
+            imguiAllocatedBytes.fetch_add(malloc_usable_size(pointer), std::memory_order_relaxed);
+            return pointer;
+        },
+        [] (void* pointer, void*) {
+            imguiAllocatedBytes.fetch_sub(malloc_usable_size(pointer), std::memory_order_relaxed);
+            std::free(pointer);
+        }
+    );
+}
+
+size_t get_imgui_allocation_count()
+{
+    return imguiAllocationCount.load(std::memory_order_relaxed);
+}
+
+size_t get_imgui_allocated_bytes()
+{
+    return imguiAllocatedBytes.load(std::memory_order_relaxed);
+}
+
+FrameStatistics compute_frame_statistics(std::span<FrameSample const> samples)
+{
+    if (samples.empty()) return {};
+
+    std::vector<std::chrono::nanoseconds> durations(samples.size());
+    std::ranges::transform(samples, durations.begin(), &FrameSample::duration);
+    std::ranges::sort(durations);
+
+    auto percentile = [&] (size_t p) { return durations.at((durations.size() - 1) * p / 100); };
+
+    auto totalDuration = std::accumulate(durations.begin(), durations.end(), std::chrono::nanoseconds {});
+    auto [allocationsMin, allocationsMax] = std::ranges::minmax(samples | std::views::transform(&FrameSample::allocations));
+    auto totalAllocations = std::accumulate(samples.begin(), samples.end(), size_t {}, [] (size_t total, auto const& sample) { return total + sample.allocations; });
+    auto totalHeapAllocations = std::accumulate(samples.begin(), samples.end(), size_t {}, [] (size_t total, auto const& sample) { return total + sample.heapAllocations; });
+
+    return {
+        .frames = samples.size(),
+        .mean = totalDuration / static_cast<long>(samples.size()),
+        .min = durations.front(),
+        .p50 = percentile(50),
+        .p90 = percentile(90),
+        .p99 = percentile(99),
+        .max = durations.back(),
+        .allocationsMean = static_cast<double>(totalAllocations) / static_cast<double>(samples.size()),
+        .allocationsMin = allocationsMin,
+        .allocationsMax = allocationsMax,
+        .heapAllocationsMean = static_cast<double>(totalHeapAllocations) / static_cast<double>(samples.size()),
+        .heapAllocationsMax = std::ranges::max(samples | std::views::transform(&FrameSample::heapAllocations)),
+    };
+}
+
+void print_frame_statistics(FrameStatistics const& statistics, std::span<FrameSample const> samples)
+{
+    auto const us = [] (std::chrono::nanoseconds value) { return static_cast<double>(value.count()) / 1000.0; };
+
+    fmt::println("frames: {}", statistics.frames);
+    fmt::println("frame time (us): mean {:.1f} min {:.1f} p50 {:.1f} p90 {:.1f} p99 {:.1f} max {:.1f}",
+        us(statistics.mean), us(statistics.min), us(statistics.p50), us(statistics.p90), us(statistics.p99), us(statistics.max));
+    fmt::println("allocations per frame: mean {:.1f} min {} max {}", statistics.allocationsMean, statistics.allocationsMin, statistics.allocationsMax);
+
+    if constexpr (COUNTING_HEAP_ALLOCATIONS)
+    {
+        fmt::println("operator new per frame: mean {:.1f} max {}", statistics.heapAllocationsMean, statistics.heapAllocationsMax);
+    }
+
+    static constexpr std::array BUCKETS_US { 50, 100, 250, 500, 1000, 2500, 5000, 10000 };
+    std::array<size_t, BUCKETS_US.size() + 1> histogram {};
+
+    for (auto const& sample : samples)
+    {
+        auto bucket = std::ranges::find_if(BUCKETS_US, [&] (int limit) { return us(sample.duration) < limit; });
+        histogram.at(static_cast<size_t>(std::distance(BUCKETS_US.begin(), bucket))) += 1;
+    }
+
+    for (size_t i = 0; i < BUCKETS_US.size(); i += 1)
+    {
+        fmt::println("  < {:>5} us: {}", BUCKETS_US.at(i), histogram.at(i));
+    }
+    fmt::println("  >={:>5} us: {}", BUCKETS_US.back(), histogram.back());
+
+    fmt::println("allocations by frame:");
+    for (size_t i = 0; i < samples.size(); i += 1)
+    {
+        if constexpr (COUNTING_HEAP_ALLOCATIONS)
+            fmt::println("  {:>5}: {:>8.1f} us {:>5} allocations {:>5} operator new", i, us(samples[i].duration), samples[i].allocations, samples[i].heapAllocations);
+        else
+            fmt::println("  {:>5}: {:>8.1f} us {:>5} allocations", i, us(samples[i].duration), samples[i].allocations);
+    }
+}
@@ -0,0 +1,482 @@
+#include "Recording.hpp"
+
+#include "Binary.hpp"
+
+#include <liberror/Try.hpp>
+#include <fmt/format.h>
+
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <type_traits>
+
+static constexpr char SESSION_MAGIC[8] { 'X', 'W', 'G', 'S', 'E', 'S', 'S', '1' };
+
+static void write_value(BinaryWriter& writer, libwacom::Area const& area) { writer.write(area); }
+static void write_value(BinaryWriter& writer, libwacom::Pressure const& pressure) { writer.write(pressure); }
+static void write_value(BinaryWriter& writer, ProductId const& productId) { writer.write(productId); }
+static void write_value(BinaryWriter&, std::unique_ptr<StylusInput> const&) {}
+static void write_value(BinaryWriter&, std::unique_ptr<DevicePropertyWatcher> const&) {}
+
+static void write_value(BinaryWriter& writer, std::string const& value) { writer.write(value); }
+
+static void write_value(BinaryWriter& writer, Monitor const& monitor)
+{
+    writer.write(monitor.id);
+    writer.write(monitor.primary);
+    writer.write(monitor.offsetX);
+    writer.write(monitor.offsetY);
+    writer.write(monitor.width);
+    writer.write(monitor.height);
+    writer.write(monitor.name);
+}
+
+static void write_value(BinaryWriter& writer, libwacom::Device const& device)
+{
+    writer.write(device.id);
+    writer.write(device.name);
+    writer.write(std::string(device.kind.to_string()));
+}
+
+template <class T>
+static void write_value(BinaryWriter& writer, std::vector<T> const& values)
+{
+    writer.write(static_cast<uint32_t>(values.size()));
+    for (auto const& value : values) write_value(writer, value);
+}
+
+static void write_value(BinaryWriter& writer, DeviceLocation const& location)
+{
+    writer.write(location.deviceId);
+    writer.write(location.location);
+}
+
+static void write_value(BinaryWriter& writer, DeviceProperty const& property)
+{
+    writer.write(property.name);
+    writer.write(property.type);
+    write_value(writer, property.values);
+}
+
+static void write_value(BinaryWriter& writer, DeviceProperties const& properties)
+{
+    writer.write(properties.deviceName);
+    write_value(writer, properties.properties);
+}
+
+static void read_value(BinaryReader& reader, libwacom::Area& area) { reader.read(area); }
+static void read_value(BinaryReader& reader, libwacom::Pressure& pressure) { reader.read(pressure); }
+static void read_value(BinaryReader& reader, ProductId& productId) { reader.read(productId); }
+
+static void read_value(BinaryReader& reader, std::string& value) { reader.read(value); }
+
+static void read_value(BinaryReader& reader, Monitor& monitor)
+{
+    reader.read(monitor.id);
+    reader.read(monitor.primary);
+    reader.read(monitor.offsetX);
+    reader.read(monitor.offsetY);
+    reader.read(monitor.width);
+    reader.read(monitor.height);
+    reader.read(monitor.name);
+}
+
+static void read_value(BinaryReader& reader, libwacom::Device& device)
+{
+    std::string kind {};
+    reader.read(device.id);
+    reader.read(device.name);
+    reader.read(kind);
+    device.kind = libwacom::Device::Kind::from_string(kind);
+}
+
+template <class T>
+static void read_value(BinaryReader& reader, std::vector<T>& values)
+{
+    uint32_t size = 0;
+    reader.read(size);
+    for (uint32_t i = 0; i < size && !reader.failed(); i += 1) read_value(reader, values.emplace_back());
+}
+
+static void read_value(BinaryReader& reader, DeviceLocation& location)
+{
+    reader.read(location.deviceId);
+    reader.read(location.location);
+}
+
+static void read_value(BinaryReader& reader, DeviceProperty& property)
+{
+    reader.read(property.name);
+    reader.read(property.type);
+    read_value(reader, property.values);
+}
+
+static void read_value(BinaryReader& reader, DeviceProperties& properties)
+{
+    reader.read(properties.deviceName);
+    read_value(reader, properties.properties);
+}
+
+template <class T>
+static std::string encode_result(liberror::Result<T> const& result)
+{
+    BinaryWriter writer {};
+    writer.write(static_cast<uint8_t>(result.has_value()));
+
+    if (!result.has_value()) writer.write(result.error().message());
+    else if constexpr (!std::is_void_v<T>) write_value(writer, *result);
+
+    return std::move(writer.buffer);
+}
+
+template <class T>
+static liberror::Result<T> decode_result(std::string_view response)
+{
+    BinaryReader reader { response };
+
+    uint8_t succeeded = 0;
+    reader.read(succeeded);
+
+    if (!succeeded)
+    {
+        std::string message {};
+        reader.read(message);
+        return liberror::make_error("{}", message);
+    }
+
+    if constexpr (std::is_void_v<T>)
+    {
+        return {};
+    }
+    else
+    {
+        T value {};
+        read_value(reader, value);
+        if (reader.failed()) return liberror::make_error("The recorded response is truncated");
+        return value;
+    }
+}
+
+template <class Function>
+static auto record_calls(Session& session, BackendCall call, Function function)
+{
+    return [&session, call, function] (auto... arguments) {
+        auto result = function(arguments...);
+        std::lock_guard lock { session.callsMutex };
+        session.calls.push_back({ call, encode_result(result) });
+        return result;
+    };
+}
+
+Backend make_recording_backend(Backend backend, Session& session)
+{
+    return {
+        .get_available_monitors = record_calls(session, BackendCall::GET_AVAILABLE_MONITORS, backend.get_available_monitors),
+        .get_available_devices = record_calls(session, BackendCall::GET_AVAILABLE_DEVICES, backend.get_available_devices),
+        .get_device_product_id = record_calls(session, BackendCall::GET_DEVICE_PRODUCT_ID, backend.get_device_product_id),
+        .get_device_locations = record_calls(session, BackendCall::GET_DEVICE_LOCATIONS, backend.get_device_locations),
+        .get_device_properties = record_calls(session, BackendCall::GET_DEVICE_PROPERTIES, backend.get_device_properties),
+        .get_stylus_default_area = record_calls(session, BackendCall::GET_STYLUS_DEFAULT_AREA, backend.get_stylus_default_area),
+        .get_stylus_area = record_calls(session, BackendCall::GET_STYLUS_AREA, backend.get_stylus_area),
+        .get_stylus_pressure_curve = record_calls(session, BackendCall::GET_STYLUS_PRESSURE_CURVE, backend.get_stylus_pressure_curve),
+        .set_stylus_area = record_calls(session, BackendCall::SET_STYLUS_AREA, backend.set_stylus_area),
+        .set_stylus_pressure_curve = record_calls(session, BackendCall::SET_STYLUS_PRESSURE_CURVE, backend.set_stylus_pressure_curve),
+        .set_stylus_output_from_display_area = record_calls(session, BackendCall::SET_STYLUS_OUTPUT_FROM_DISPLAY_AREA, backend.set_stylus_output_from_display_area),
+        .open_stylus_input = record_calls(session, BackendCall::OPEN_STYLUS_INPUT, backend.open_stylus_input),
+        .watch_device_properties = record_calls(session, BackendCall::WATCH_DEVICE_PROPERTIES, backend.watch_device_properties),
+    };
+}
+
+struct ReplayState
+{
+    std::mutex mutex;
+    std::map<BackendCall, std::deque<std::string>> responses;
+    size_t* unrecordedCalls;
+
+    std::optional<std::string> next(BackendCall call)
+    {
+        std::lock_guard lock { mutex };
+
+        auto& queue = responses[call];
+        if (queue.empty())
+        {
+            *unrecordedCalls += 1;
+            return std::nullopt;
+        }
+
+        auto response = std::move(queue.front());
+        queue.pop_front();
+        return response;
+    }
+};
+
+template <class Function>
+static auto replay_calls(std::shared_ptr<ReplayState> state, BackendCall call, Function fallback)
+{
+    return [state, call, fallback] (auto... arguments) {
+        using Result = decltype(fallback(arguments...));
+        if (auto response = state->next(call)) return decode_result<typename Result::value_type>(*response);
+        return fallback(arguments...);
+    };
+}
+
+Backend make_replay_backend(Session& session, Backend fallback, size_t& unrecordedCalls)
+{
+    auto state = std::make_shared<ReplayState>();
+    state->unrecordedCalls = &unrecordedCalls;
+
+    for (auto& [call, response] : session.calls)
+    {
+        state->responses[call].push_back(response);
+    }
+
+    return {
+        .get_available_monitors = replay_calls(state, BackendCall::GET_AVAILABLE_MONITORS, fallback.get_available_monitors),
+        .get_available_devices = replay_calls(state, BackendCall::GET_AVAILABLE_DEVICES, fallback.get_available_devices),
+        .get_device_product_id = replay_calls(state, BackendCall::GET_DEVICE_PRODUCT_ID, fallback.get_device_product_id),
+        .get_device_locations = replay_calls(state, BackendCall::GET_DEVICE_LOCATIONS, fallback.get_device_locations),
+        .get_device_properties = replay_calls(state, BackendCall::GET_DEVICE_PROPERTIES, fallback.get_device_properties),
+        .get_stylus_default_area = replay_calls(state, BackendCall::GET_STYLUS_DEFAULT_AREA, fallback.get_stylus_default_area),
+        .get_stylus_area = replay_calls(state, BackendCall::GET_STYLUS_AREA, fallback.get_stylus_area),
+        .get_stylus_pressure_curve = replay_calls(state, BackendCall::GET_STYLUS_PRESSURE_CURVE, fallback.get_stylus_pressure_curve),
+        .set_stylus_area = replay_calls(state, BackendCall::SET_STYLUS_AREA, fallback.set_stylus_area),
+        .set_stylus_pressure_curve = replay_calls(state, BackendCall::SET_STYLUS_PRESSURE_CURVE, fallback.set_stylus_pressure_curve),
+        .set_stylus_output_from_display_area = replay_calls(state, BackendCall::SET_STYLUS_OUTPUT_FROM_DISPLAY_AREA, fallback.set_stylus_output_from_display_area),
+        // the stylus stream and the property changes are not part of a recording, only whether they could be opened
+        .open_stylus_input = [state] (std::string_view) -> liberror::Result<std::unique_ptr<StylusInput>> {
+            state->next(BackendCall::OPEN_STYLUS_INPUT);
+            return liberror::make_error("Replays carry no stylus input");
+        },
+        .watch_device_properties = [state] (std::string_view) -> liberror::Result<std::unique_ptr<DevicePropertyWatcher>> {
+            state->next(BackendCall::WATCH_DEVICE_PROPERTIES);
+            return liberror::make_error("Replays carry no device property changes");
+        },
+    };
+}
+
+liberror::Result<void> save_session(std::filesystem::path const& path, Session& session)
+{
+    BinaryWriter writer {};
+
+    writer.write(SESSION_MAGIC);
+    writer.write(session.windowSize);
+    writer.write(session.scale);
+    writer.write(session.applicationSettings.scale);
+    writer.write(session.applicationSettings.theme);
+    writer.write(std::string(session.applicationSettings.language.to_string()));
+    writer.write(session.applicationSettings.font);
+    writer.write(static_cast<uint8_t>(session.deviceSettingsFile.has_value()));
+    if (session.deviceSettingsFile.has_value()) writer.write(*session.deviceSettingsFile);
+
+    writer.write(static_cast<uint32_t>(session.frames.size()));
+    for (auto const& frame : session.frames)
+    {
+        writer.write(frame.deltaTime);
+        writer.write(frame.mousePosition);
+        writer.write(frame.mouseButtons);
+        writer.write(frame.mouseWheel);
+        writer.write(static_cast<uint16_t>(frame.keys.size()));
+        for (auto const& [key, down] : frame.keys)
+        {
+            writer.write(static_cast<int32_t>(key));
+            writer.write(static_cast<uint8_t>(down));
+        }
+        writer.write(static_cast<uint16_t>(frame.characters.size()));
+        for (auto character : frame.characters) writer.write(character);
+        writer.write(static_cast<int64_t>(frame.sample.duration.count()));
+        writer.write(static_cast<uint64_t>(frame.sample.allocations));
+    }
+
+    std::lock_guard lock { session.callsMutex };
+
+    writer.write(static_cast<uint32_t>(session.calls.size()));
+    for (auto const& [call, response] : session.calls)
+    {
+        writer.write(call);
+        writer.write(response);
+    }
+
+    std::ofstream stream(path, std::ios::binary);
+    stream.write(writer.buffer.data(), static_cast<std::streamsize>(writer.buffer.size()));
+
+    if (stream.bad() || stream.fail())
+        return liberror::make_error("Failed to write the session to {}", path.string());
+
+    return {};
+}
+
+liberror::Result<void> load_session(std::filesystem::path const& path, Session& session)
+{
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream.is_open())
+        return liberror::make_error("Failed to open the session {}", path.string());
+
+    std::stringstream content;
+    content << stream.rdbuf();
+    auto const data = content.str();
+
+    BinaryReader reader { data };
+
+    char magic[sizeof(SESSION_MAGIC)] {};
+    reader.read(magic);
+    if (reader.failed() || std::memcmp(magic, SESSION_MAGIC, sizeof(magic)) != 0)
+        return liberror::make_error("{} is not a session recorded by this version of " NAME, path.string());
+
+    std::string language {};
+    uint8_t hasDeviceSettingsFile = 0;
+
+    reader.read(session.windowSize);
+    reader.read(session.scale);
+    reader.read(session.applicationSettings.scale);
+    reader.read(session.applicationSettings.theme);
+    reader.read(language);
+    reader.read(session.applicationSettings.font);
+    reader.read(hasDeviceSettingsFile);
+    if (hasDeviceSettingsFile) reader.read(session.deviceSettingsFile.emplace());
+
+    session.applicationSettings.language = ApplicationSettings::Language::from_string(language);
+
+    uint32_t frames = 0;
+    reader.read(frames);
+    for (uint32_t i = 0; i < frames && !reader.failed(); i += 1)
+    {
+        auto& frame = session.frames.emplace_back();
+        uint16_t keys = 0, characters = 0;
+        int64_t duration = 0;
+        uint64_t allocations = 0;
+
+        reader.read(frame.deltaTime);
+        reader.read(frame.mousePosition);
+        reader.read(frame.mouseButtons);
+        reader.read(frame.mouseWheel);
+        reader.read(keys);
+        for (uint16_t key = 0; key < keys; key += 1)
+        {
+            int32_t code = 0;
+            uint8_t down = 0;
+            reader.read(code);
+            reader.read(down);
+            frame.keys.push_back({ static_cast<ImGuiKey>(code), down != 0 });
+        }
+        reader.read(characters);
+        for (uint16_t character = 0; character < characters; character += 1) reader.read(frame.characters.emplace_back());
+        reader.read(duration);
+        reader.read(allocations);
+
+        frame.sample = { std::chrono::nanoseconds(duration), static_cast<size_t>(allocations), 0 };
+    }
+
+    uint32_t calls = 0;
+    reader.read(calls);
+    for (uint32_t i = 0; i < calls && !reader.failed(); i += 1)
+    {
+        auto& call = session.calls.emplace_back();
+        reader.read(call.call);
+        reader.read(call.response);
+    }
+
+    if (reader.failed())
+        return liberror::make_error("The session {} is truncated", path.string());
+
+    return {};
+}
+
+RecordedFrame capture_frame_input(ImGuiIO const& io, std::vector<bool>& keysDown)
+{
+    RecordedFrame frame {
+        .deltaTime = io.DeltaTime,
+        .mousePosition = io.MousePos,
+        .mouseButtons = 0,
+        .mouseWheel = { io.MouseWheelH, io.MouseWheel },
+        .keys = {},
+        .characters = {},
+        .sample = {},
+    };
+
+    for (int button = 0; button < 5; button += 1)
+    {
+        if (io.MouseDown[button]) frame.mouseButtons = static_cast<uint8_t>(frame.mouseButtons | (1 << button));
+    }
+
+    keysDown.resize(ImGuiKey_NamedKey_END - ImGuiKey_NamedKey_BEGIN);
+    for (int key = ImGuiKey_NamedKey_BEGIN; key < ImGuiKey_NamedKey_END; key += 1)
+    {
+        auto const down = ImGui::IsKeyDown(static_cast<ImGuiKey>(key));
+        auto&& wasDown = keysDown[static_cast<size_t>(key - ImGuiKey_NamedKey_BEGIN)];
+        if (down == wasDown) continue;
+
+        frame.keys.push_back({ static_cast<ImGuiKey>(key), down });
+        wasDown = down;
+    }
+
+    for (auto character : io.InputQueueCharacters)
+    {
+        frame.characters.push_back(character);
+    }
+
+    return frame;
+}
+
+void push_frame_input(ImGuiIO& io, RecordedFrame const& frame)
+{
+    io.DeltaTime = frame.deltaTime;
+    io.AddMousePosEvent(frame.mousePosition.x, frame.mousePosition.y);
+
+    for (int button = 0; button < 5; button += 1)
+    {
+        io.AddMouseButtonEvent(button, (frame.mouseButtons & (1 << button)) != 0);
+    }
+
+    if (frame.mouseWheel.x != 0 || frame.mouseWheel.y != 0)
+    {
+        io.AddMouseWheelEvent(frame.mouseWheel.x, frame.mouseWheel.y);
+    }
+
+    for (auto const& [key, down] : frame.keys)
+    {
+        io.AddKeyEvent(key, down);
+    }
+
+    for (auto character : frame.characters)
+    {
+        io.AddInputCharacter(character);
+    }
+}
+
+void print_replay_comparison(std::span<RecordedFrame const> recorded, std::span<FrameSample const> replayed, size_t unrecordedCalls)
+{
+    std::vector<FrameSample> recordedSamples {};
+    for (auto const& frame : recorded) recordedSamples.push_back(frame.sample);
+
+    auto const before = compute_frame_statistics(recordedSamples);
+    auto const after = compute_frame_statistics(replayed);
+
+    auto const microseconds = [] (std::chrono::nanoseconds duration) { return static_cast<double>(duration.count()) / 1000.0; };
+    auto const change = [] (double from, double to) { return from > 0 ? (to - from) / from * 100.0 : 0.0; };
+
+    fmt::println("frames: {}", after.frames);
+    fmt::println("");
+    fmt::println("{:<18} {:>12} {:>12} {:>9}", "", "recorded", "replayed", "change");
+
+    for (auto [name, from, to] : {
+        std::tuple { "mean (us)", before.mean, after.mean },
+        std::tuple { "p50 (us)", before.p50, after.p50 },
+        std::tuple { "p90 (us)", before.p90, after.p90 },
+        std::tuple { "p99 (us)", before.p99, after.p99 },
+        std::tuple { "max (us)", before.max, after.max },
+    })
+    {
+        fmt::println("{:<18} {:>12.1f} {:>12.1f} {:>8.1f}%", name, microseconds(from), microseconds(to), change(microseconds(from), microseconds(to)));
+    }
+
+    fmt::println("{:<18} {:>12.1f} {:>12.1f} {:>8.1f}%", "allocations/frame", before.allocationsMean, after.allocationsMean, change(before.allocationsMean, after.allocationsMean));
+
+    if (unrecordedCalls != 0)
+    {
+        fmt::println("");
+        fmt::println("{} backend calls were not part of the recording and were answered by the fake backend", unrecordedCalls);
+    }
+}
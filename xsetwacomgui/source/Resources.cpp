@@ -0,0 +1,80 @@
+#include "Resources.hpp"
+
+#include "Environment.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+
+static std::optional<std::span<unsigned char const>> find_packed_resource(std::string_view name)
+{
+    auto const index = get_packed_index();
+    auto const entry = std::ranges::lower_bound(index, name, {}, [] (PackedResource const& resource) { return std::string_view(resource.name); });
+
+    if (entry == index.end() || entry->name != name) return std::nullopt;
+
+    return get_packed_data().subspan(entry->offset, entry->size);
+}
+
+liberror::Result<std::span<unsigned char const>> get_resource(std::string_view name)
+{
+    // overrides are read once and kept, lookups that found nothing on disk are remembered as well
+    static std::mutex mutex;
+    static std::map<std::string, std::optional<std::vector<unsigned char>>, std::less<>> overrides;
+
+    std::lock_guard lock { mutex };
+
+    auto cached = overrides.find(name);
+
+    if (cached == overrides.end())
+    {
+        std::optional<std::vector<unsigned char>> content {};
+
+        if (std::ifstream stream(get_application_data_path() / name, std::ios::binary); stream.is_open())
+        {
+            content.emplace(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+        }
+
+        cached = overrides.emplace(std::string(name), std::move(content)).first;
+    }
+
+    if (cached->second.has_value())
+    {
+        return std::span<unsigned char const>(*cached->second);
+    }
+
+    if (auto packed = find_packed_resource(name))
+    {
+        return *packed;
+    }
+
+    return liberror::make_error("Resource \"{}\" could not be found", name);
+}
+
+std::vector<std::string> list_resources(std::string_view directory)
+{
+    std::set<std::string> names {};
+
+    auto const prefix = std::string(directory) + "/";
+
+    for (auto const& resource : get_packed_index())
+    {
+        std::string_view const name { resource.name };
+        if (name.starts_with(prefix) && name.find('/', prefix.size()) == std::string_view::npos) names.emplace(name);
+    }
+
+    if (std::error_code error {}; std::filesystem::is_directory(get_application_data_path() / directory, error))
+    {
+        for (auto const& entry : std::filesystem::directory_iterator(get_application_data_path() / directory, error))
+        {
+            if (entry.is_regular_file()) names.insert(prefix + entry.path().filename().string());
+        }
+    }
+
+    return { names.begin(), names.end() };
+}
@@ -0,0 +1,212 @@
+#include "Scenarios.hpp"
+
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+static constexpr double DEFAULT_BUDGET_US = 16666;
+static constexpr int DEFAULT_TOLERANCE = 8;
+static constexpr double DEFAULT_DIFFERING_PIXELS = 0.001;
+
+liberror::Result<Scenario> load_scenario(std::filesystem::path const& path)
+{
+    std::ifstream stream(path);
+    if (!stream.is_open())
+        return liberror::make_error("Failed to open the scenario {}", path.string());
+
+    auto const json = nlohmann::json::parse(stream, nullptr, false);
+    if (json.is_discarded() || !json.contains("steps") || !json["steps"].is_array())
+        return liberror::make_error("The scenario {} is not an object with a list of steps", path.string());
+
+    Scenario scenario {
+        .name = path.stem().string(),
+        .budgetUs = json.value("budgetUs", DEFAULT_BUDGET_US),
+        .tolerance = json.value("tolerance", DEFAULT_TOLERANCE),
+        .differingPixels = json.value("differingPixels", DEFAULT_DIFFERING_PIXELS),
+        .frames = {},
+    };
+
+    // what the steps since the last frame asked for, it goes into the next frame
+    ScenarioFrame pending {};
+    ImVec2 mouse { 0, 0 };
+
+    auto const emit = [&] (size_t count) {
+        for (size_t i = 0; i < count; i += 1)
+        {
+            scenario.frames.push_back(std::exchange(pending, {}));
+        }
+    };
+
+    try
+    {
+        for (auto const& step : json["steps"])
+        {
+            if (step.contains("move"))
+            {
+                ImVec2 const target { step["move"][0].get<float>(), step["move"][1].get<float>() };
+                auto const frames = step.value("frames", size_t { 0 });
+
+                // a move over some frames is a drag when the button is held, each frame gets one step of it
+                for (size_t frame = 1; frame <= frames; frame += 1)
+                {
+                    auto const t = static_cast<float>(frame) / static_cast<float>(frames);
+                    pending.mouse = ImVec2 { mouse.x + (target.x - mouse.x) * t, mouse.y + (target.y - mouse.y) * t };
+                    emit(1);
+                }
+
+                pending.mouse = target;
+                mouse = target;
+            }
+            else if (step.contains("press"))
+            {
+                pending.leftButton = true;
+            }
+            else if (step.contains("release"))
+            {
+                pending.leftButton = false;
+            }
+            else if (step.contains("theme"))
+            {
+                pending.theme = step["theme"].get<std::string>();
+            }
+            else if (step.contains("language"))
+            {
+                pending.language = ApplicationSettings::Language::from_string(step["language"].get<std::string>());
+            }
+            else if (step.contains("scale"))
+            {
+                pending.scale = step["scale"].get<float>();
+            }
+            else if (step.contains("wait"))
+            {
+                emit(step["wait"].get<size_t>());
+            }
+            else if (step.contains("capture"))
+            {
+                // whatever was still pending gets a frame of its own before the capture is taken
+                pending.capture = step["capture"].get<std::string>();
+                emit(1);
+            }
+            else
+            {
+                return liberror::make_error("The scenario {} has an unknown step: {}", path.string(), step.dump());
+            }
+        }
+    }
+    catch (nlohmann::json::exception const& exception)
+    {
+        return liberror::make_error("The scenario {} is malformed: {}", path.string(), exception.what());
+    }
+
+    emit(pending.mouse || pending.leftButton || pending.theme || pending.language || pending.scale ? 1 : 0);
+
+    return scenario;
+}
+
+std::vector<std::filesystem::path> find_scenarios(std::filesystem::path const& directory)
+{
+    std::vector<std::filesystem::path> scenarios {};
+
+    std::error_code error {};
+    for (auto const& entry : std::filesystem::directory_iterator(directory, error))
+    {
+        if (entry.path().extension() == ".json") scenarios.push_back(entry.path());
+    }
+
+    std::ranges::sort(scenarios);
+    return scenarios;
+}
+
+liberror::Result<void> save_image(std::filesystem::path const& path, Image const& image)
+{
+    std::string data = fmt::format("P6\n{} {}\n255\n", image.width, image.height);
+    data.reserve(data.size() + image.pixels.size() * 3);
+
+    for (auto const pixel : image.pixels)
+    {
+        data.push_back(static_cast<char>(pixel & 0xFF));
+        data.push_back(static_cast<char>(pixel >> 8 & 0xFF));
+        data.push_back(static_cast<char>(pixel >> 16 & 0xFF));
+    }
+
+    std::error_code error {};
+    std::filesystem::create_directories(path.parent_path(), error);
+
+    std::ofstream stream(path, std::ios::binary);
+    stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+
+    if (stream.bad() || stream.fail())
+        return liberror::make_error("Failed to write the image {}", path.string());
+
+    return {};
+}
+
+liberror::Result<Image> load_image(std::filesystem::path const& path)
+{
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream.is_open())
+        return liberror::make_error("Failed to open the image {}", path.string());
+
+    std::string magic;
+    int width = 0, height = 0, maximum = 0;
+    stream >> magic >> width >> height >> maximum;
+    stream.get();
+
+    if (!stream || magic != "P6" || maximum != 255 || width <= 0 || height <= 0)
+        return liberror::make_error("{} is not a binary ppm with 8 bits per channel", path.string());
+
+    Image image { width, height, std::vector<uint32_t>(static_cast<size_t>(width) * static_cast<size_t>(height)) };
+    std::string data(image.pixels.size() * 3, '\0');
+    stream.read(data.data(), static_cast<std::streamsize>(data.size()));
+
+    if (stream.gcount() != static_cast<std::streamsize>(data.size()))
+        return liberror::make_error("The image {} is truncated", path.string());
+
+    for (size_t i = 0; i < image.pixels.size(); i += 1)
+    {
+        auto const channel = [&] (size_t offset) { return static_cast<uint32_t>(static_cast<unsigned char>(data[i * 3 + offset])); };
+        image.pixels[i] = 0xFF000000 | channel(2) << 16 | channel(1) << 8 | channel(0);
+    }
+
+    return image;
+}
+
+ImageComparison compare_images(Image const& expected, Image const& actual, int tolerance)
+{
+    if (expected.width != actual.width || expected.height != actual.height)
+    {
+        return { actual.pixels.size(), 255, actual };
+    }
+
+    ImageComparison comparison { 0, 0, { expected.width, expected.height, std::vector<uint32_t>(expected.pixels.size()) } };
+
+    for (size_t i = 0; i < expected.pixels.size(); i += 1)
+    {
+        auto difference = 0;
+        for (auto shift = 0; shift < 24; shift += 8)
+        {
+            auto const lhs = static_cast<int>(expected.pixels[i] >> shift & 0xFF);
+            auto const rhs = static_cast<int>(actual.pixels[i] >> shift & 0xFF);
+            difference = std::max(difference, std::abs(lhs - rhs));
+        }
+
+        comparison.maxDifference = std::max(comparison.maxDifference, difference);
+
+        if (difference > tolerance)
+        {
+            comparison.differingPixels += 1;
+            comparison.difference.pixels[i] = 0xFF0000FF;
+        }
+        else
+        {
+            // a quarter of the expected image, enough to tell where on the window the differences are
+            comparison.difference.pixels[i] = 0xFF000000 | (expected.pixels[i] >> 2 & 0x3F3F3F);
+        }
+    }
+
+    return comparison;
+}
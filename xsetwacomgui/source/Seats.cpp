@@ -0,0 +1,103 @@
+#include "Seats.hpp"
+
+#include "Process.hpp"
+#include "Settings.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+
+std::vector<std::string> find_displays(std::filesystem::path const& socketDirectory)
+{
+    std::vector<int> numbers {};
+    std::error_code error {};
+
+    for (auto const& entry : std::filesystem::directory_iterator(socketDirectory, error))
+    {
+        // the server listening on ":N" owns the socket "XN"
+        auto const name = entry.path().filename().string();
+        if (name.size() < 2 || name.front() != 'X') continue;
+
+        int number = 0;
+        auto const [end, result] = std::from_chars(name.data() + 1, name.data() + name.size(), number);
+        if (result == std::errc {} && end == name.data() + name.size()) numbers.push_back(number);
+    }
+
+    std::ranges::sort(numbers);
+
+    std::vector<std::string> displays {};
+    for (auto number : numbers) displays.push_back(fmt::format(":{}", number));
+
+    return displays;
+}
+
+std::filesystem::path get_seat_settings_file(std::string_view display)
+{
+    // "host:1.0" and ":1" are the same seat
+    auto number = display.substr(display.rfind(':') + 1);
+    number = number.substr(0, number.find('.'));
+
+    auto const file = SEAT_SETTINGS_PATH / fmt::format("{}.json", number);
+    return std::filesystem::exists(file) ? file : DEVICE_SETTINGS_FILE;
+}
+
+static std::string trim_trailing_newlines(std::string text)
+{
+    while (!text.empty() && text.back() == '\n') text.pop_back();
+    return text;
+}
+
+nlohmann::ordered_json apply_settings_to_displays(std::vector<std::string> const& displays)
+{
+    static constexpr auto TIMEOUT = std::chrono::seconds(30);
+
+    auto const milliseconds = [] (std::chrono::nanoseconds duration) { return std::chrono::duration<double, std::milli>(duration).count(); };
+
+    std::vector<std::filesystem::path> settings {};
+    std::vector<std::vector<std::string>> commands {};
+
+    // every backend call talks to the display in DISPLAY, xsetwacom included, so a process per display is
+    // what keeps their connections apart
+    for (auto const& display : displays)
+    {
+        settings.push_back(get_seat_settings_file(display));
+        commands.push_back({ "/proc/self/exe", "--no-gui", fmt::format("--display={}", display), fmt::format("--device-settings={}", settings.back().string()) });
+    }
+
+    auto const start = std::chrono::steady_clock::now();
+    auto const results = run_processes(commands, { .timeout = TIMEOUT });
+    auto const duration = std::chrono::steady_clock::now() - start;
+
+    nlohmann::ordered_json report { { "displays", nlohmann::ordered_json::array() } };
+    size_t failed = 0;
+
+    for (size_t i = 0; i < displays.size(); i += 1)
+    {
+        nlohmann::ordered_json entry { { "display", displays[i] }, { "settings", settings[i].string() } };
+        auto const& result = results[i];
+
+        if (!result.has_value())
+        {
+            entry["succeeded"] = false;
+            entry["error"] = result.error().message();
+        }
+        else
+        {
+            entry["succeeded"] = result->exitStatus == 0;
+            entry["durationMs"] = milliseconds(result->duration);
+            entry["output"] = trim_trailing_newlines(result->output);
+            if (!result->error.empty()) entry["error"] = trim_trailing_newlines(result->error);
+        }
+
+        if (!entry["succeeded"].get<bool>()) failed += 1;
+
+        report["displays"].push_back(entry);
+    }
+
+    report["failed"] = failed;
+    report["durationMs"] = milliseconds(duration);
+
+    return report;
+}
@@ -1,14 +1,38 @@
 #include "Settings.hpp"
 
+#include "Trace.hpp"
+
 #include <nlohmann/json.hpp>
 
 #include <fstream>
 #include <sstream>
 #include <cstdlib>
 
-bool load_device_settings(DeviceSettings& settings)
+static libwacom::Area area_from_json(nlohmann::json const& json)
+{
+    return { json["offsetX"].get<float>(), json["offsetY"].get<float>(), json["width"].get<float>(), json["height"].get<float>() };
+}
+
+static libwacom::Pressure pressure_from_json(nlohmann::json const& json)
+{
+    return { json["minX"].get<float>(), json["minY"].get<float>(), json["maxX"].get<float>(), json["maxY"].get<float>() };
+}
+
+static nlohmann::ordered_json area_to_json(libwacom::Area const& area)
+{
+    return { { "offsetX", area.offsetX }, { "offsetY", area.offsetY }, { "width", area.width }, { "height", area.height } };
+}
+
+static nlohmann::ordered_json pressure_to_json(libwacom::Pressure const& pressure)
 {
-    std::ifstream stream(DEVICE_SETTINGS_FILE);
+    return { { "minX", pressure.minX }, { "minY", pressure.minY }, { "maxX", pressure.maxX }, { "maxY", pressure.maxY } };
+}
+
+bool load_device_settings(DeviceSettings& settings, std::filesystem::path const& file)
+{
+    TRACE_SCOPE("load_device_settings");
+
+    std::ifstream stream(file);
     std::stringstream content;
     content << stream.rdbuf();
 
@@ -33,6 +57,14 @@ bool load_device_settings(DeviceSettings& settings)
         settings.devicePressure.minY     = json["devicePressure"]["minY"].get<float>();
         settings.devicePressure.maxX     = json["devicePressure"]["maxX"].get<float>();
         settings.devicePressure.maxY     = json["devicePressure"]["maxY"].get<float>();
+
+        settings.deviceOverrides.clear();
+        for (auto const& [kind, values] : json.value("deviceOverrides", nlohmann::json::object()).items())
+        {
+            auto& deviceOverride = settings.deviceOverrides[kind];
+            if (values.contains("deviceArea")) deviceOverride.deviceArea = area_from_json(values["deviceArea"]);
+            if (values.contains("devicePressure")) deviceOverride.devicePressure = pressure_from_json(values["devicePressure"]);
+        }
     }
     catch (std::exception const& error)
     {
@@ -44,6 +76,8 @@ bool load_device_settings(DeviceSettings& settings)
 
 bool save_device_settings(DeviceSettings const& settings)
 {
+    TRACE_SCOPE("save_device_settings");
+
     nlohmann::ordered_json json {
         { "deviceName", settings.deviceName },
         {
@@ -77,6 +111,15 @@ bool save_device_settings(DeviceSettings const& settings)
         { "monitorForceAspectRatio", settings.monitorForceAspectRatio },
     };
 
+    // only ever written by hand, so it is left out unless there is something in it
+    for (auto const& [kind, deviceOverride] : settings.deviceOverrides)
+    {
+        auto& values = json["deviceOverrides"][kind];
+        values = nlohmann::ordered_json::object();
+        if (deviceOverride.deviceArea) values["deviceArea"] = area_to_json(*deviceOverride.deviceArea);
+        if (deviceOverride.devicePressure) values["devicePressure"] = pressure_to_json(*deviceOverride.devicePressure);
+    }
+
     std::ofstream stream(DEVICE_SETTINGS_FILE);
     stream << std::setw(4) << json;
 
@@ -85,6 +128,8 @@ bool save_device_settings(DeviceSettings const& settings)
 
 bool load_application_settings(ApplicationSettings& settings)
 {
+    TRACE_SCOPE("load_application_settings");
+
     std::ifstream stream(APPLICATION_SETTINGS_FILE);
     std::stringstream content;
     content << stream.rdbuf();
@@ -93,7 +138,7 @@ bool load_application_settings(ApplicationSettings& settings)
     {
         auto json = nlohmann::json::parse(content.str());
 
-        settings.theme    = ApplicationSettings::Theme::from_string((json["appearance"]["theme"].get<std::string>()));
+        settings.theme    = json["appearance"]["theme"].get<std::string>();
         settings.font     = json["appearance"]["font"].get<std::string>();
         settings.scale    = json["display"]["scale"].get<float>();
         settings.language = ApplicationSettings::Language::from_string(json["language"]["language"].get<std::string>());
@@ -108,10 +153,12 @@ bool load_application_settings(ApplicationSettings& settings)
 
 bool save_application_settings(ApplicationSettings& settings)
 {
+    TRACE_SCOPE("save_application_settings");
+
     nlohmann::ordered_json json {
         {
             "appearance", {
-                { "theme", settings.theme.to_string() },
+                { "theme", settings.theme },
                 { "font", settings.font },
             }
         },
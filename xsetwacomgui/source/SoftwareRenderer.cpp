@@ -0,0 +1,570 @@
+#include "SoftwareRenderer.hpp"
+
+#include "Memory.hpp"
+#include "Trace.hpp"
+
+#include <liberror/Try.hpp>
+#include <GL/gl.h>
+#include <GLFW/glfw3.h>
+#define GLFW_EXPOSE_NATIVE_X11
+#include <GLFW/glfw3native.h>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+SoftwareRenderer*& the_software_renderer()
+{
+    static SoftwareRenderer* renderer = nullptr;
+    return renderer;
+}
+
+ImTextureID create_texture(int width, int height, uint32_t const* pixels)
+{
+    if (auto renderer = the_software_renderer()) return renderer->create_texture(width, height, pixels);
+
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+
+    return static_cast<ImTextureID>(texture);
+}
+
+void destroy_texture(ImTextureID texture)
+{
+    if (auto renderer = the_software_renderer())
+    {
+        renderer->destroy_texture(texture);
+        return;
+    }
+
+    auto const name = static_cast<GLuint>(texture);
+    glDeleteTextures(1, &name);
+}
+
+// straight alpha, the same as the opengl backend does it. two channels are worked on at a time, each in
+// its own 16 bits, and x / 255 is approximated with (x + (x >> 8)) >> 8 after rounding.
+static uint32_t blend(uint32_t destination, uint32_t source)
+{
+    auto const alpha = source >> 24;
+    if (alpha == 0) return destination;
+    if (alpha == 255) return source;
+
+    auto const inverse = 255 - alpha;
+
+    auto redBlue = (source & 0x00FF00FF) * alpha + (destination & 0x00FF00FF) * inverse + 0x00800080;
+    redBlue = ((redBlue + ((redBlue >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+
+    auto greenAlpha = ((source >> 8) & 0x00FF00FF) * alpha + ((destination >> 8) & 0x00FF00FF) * inverse + 0x00800080;
+    greenAlpha = (greenAlpha + ((greenAlpha >> 8) & 0x00FF00FF)) & 0xFF00FF00;
+
+    return redBlue | greenAlpha;
+}
+
+static uint32_t modulate(uint32_t texel, uint32_t colour)
+{
+    if (texel == 0xFFFFFFFF) return colour;
+
+    uint32_t result = 0;
+    for (uint32_t shift = 0; shift < 32; shift += 8)
+    {
+        auto const product = ((texel >> shift) & 0xFF) * ((colour >> shift) & 0xFF);
+        result |= ((product + 127) / 255) << shift;
+    }
+
+    return result;
+}
+
+// most of what imgui draws is flat: backgrounds, frames, text selections and the solid part of lines
+static void blend_span(uint32_t* span, int count, uint32_t colour)
+{
+    auto const alpha = colour >> 24;
+    if (alpha == 0) return;
+
+    if (alpha == 255)
+    {
+        std::fill_n(span, count, colour);
+        return;
+    }
+
+    auto i = 0;
+
+#if defined(__SSE2__)
+    // four pixels at a time, widened to 16 bits per channel, with the same rounding as blend()
+    auto const zero = _mm_setzero_si128();
+    auto const inverse = _mm_set1_epi16(static_cast<short>(255 - alpha));
+    auto const source = _mm_add_epi16(
+        _mm_mullo_epi16(_mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(colour)), zero), _mm_set1_epi16(static_cast<short>(alpha))),
+        _mm_set1_epi16(128)
+    );
+
+    for (; i + 4 <= count; i += 4)
+    {
+        auto const pixels = _mm_loadu_si128(reinterpret_cast<__m128i const*>(span + i));
+
+        auto low = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(pixels, zero), inverse), source);
+        auto high = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(pixels, zero), inverse), source);
+        low = _mm_srli_epi16(_mm_add_epi16(low, _mm_srli_epi16(low, 8)), 8);
+        high = _mm_srli_epi16(_mm_add_epi16(high, _mm_srli_epi16(high, 8)), 8);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(span + i), _mm_packus_epi16(low, high));
+    }
+#endif
+
+    for (; i < count; i += 1) span[i] = blend(span[i], colour);
+}
+
+namespace {
+
+struct Canvas
+{
+    uint32_t* pixels;
+    int width;
+    int left, top, right, bottom; // the clip rectangle, right and bottom excluded
+};
+
+struct Sampler
+{
+    int width, height;
+    uint32_t const* pixels;
+
+    uint32_t sample(float u, float v) const
+    {
+        auto const x = std::clamp(static_cast<int>(u * static_cast<float>(width)), 0, width - 1);
+        auto const y = std::clamp(static_cast<int>(v * static_cast<float>(height)), 0, height - 1);
+        return pixels[static_cast<size_t>(y) * static_cast<size_t>(width) + static_cast<size_t>(x)];
+    }
+};
+
+// an attribute over the triangle as a plane, so that it can be read at any pixel
+struct Plane
+{
+    float origin, dx, dy;
+
+    float at(float x, float y) const { return origin + dx * x + dy * y; }
+};
+
+}
+
+static Plane make_plane(ImVec2 const (&points)[3], float const (&values)[3], float area)
+{
+    auto const dx = ((values[1] - values[0]) * (points[2].y - points[0].y) - (values[2] - values[0]) * (points[1].y - points[0].y)) / area;
+    auto const dy = ((values[2] - values[0]) * (points[1].x - points[0].x) - (values[1] - values[0]) * (points[2].x - points[0].x)) / area;
+    return { values[0] - dx * points[0].x - dy * points[0].y, dx, dy };
+}
+
+static float channel(ImU32 colour, int shift)
+{
+    return static_cast<float>((colour >> shift) & 0xFF);
+}
+
+// pixel centres are sampled, a pixel belongs to a triangle when its centre is inside of it or on its top or left
+// edge, so that the two triangles of a quad never blend the pixels along their shared edge twice
+static void draw_triangle(Canvas const& canvas, Sampler const& texture, ImDrawVert const& a, ImDrawVert const& b, ImDrawVert const& c, ImVec2 origin)
+{
+    ImVec2 const points[3] { { a.pos.x - origin.x, a.pos.y - origin.y }, { b.pos.x - origin.x, b.pos.y - origin.y }, { c.pos.x - origin.x, c.pos.y - origin.y } };
+
+    auto const area = (points[1].x - points[0].x) * (points[2].y - points[0].y) - (points[2].x - points[0].x) * (points[1].y - points[0].y);
+    if (std::abs(area) < std::numeric_limits<float>::epsilon()) return;
+
+    auto const minY = std::min({ points[0].y, points[1].y, points[2].y });
+    auto const maxY = std::max({ points[0].y, points[1].y, points[2].y });
+    auto const top = std::max(canvas.top, static_cast<int>(std::ceil(minY - 0.5f)));
+    auto const bottom = std::min(canvas.bottom, static_cast<int>(std::ceil(maxY - 0.5f)));
+    if (top >= bottom) return;
+
+    auto const sameColour = a.col == b.col && b.col == c.col;
+    auto const sameTexel = a.uv.x == b.uv.x && b.uv.x == c.uv.x && a.uv.y == b.uv.y && b.uv.y == c.uv.y;
+    auto const flat = sameColour && sameTexel;
+    auto const flatColour = modulate(texture.sample(a.uv.x, a.uv.y), a.col);
+
+    Plane u {}, v {}, red {}, green {}, blue {}, alpha {};
+
+    if (!flat)
+    {
+        u = make_plane(points, { a.uv.x, b.uv.x, c.uv.x }, area);
+        v = make_plane(points, { a.uv.y, b.uv.y, c.uv.y }, area);
+
+        if (!sameColour)
+        {
+            red = make_plane(points, { channel(a.col, 0), channel(b.col, 0), channel(c.col, 0) }, area);
+            green = make_plane(points, { channel(a.col, 8), channel(b.col, 8), channel(c.col, 8) }, area);
+            blue = make_plane(points, { channel(a.col, 16), channel(b.col, 16), channel(c.col, 16) }, area);
+            alpha = make_plane(points, { channel(a.col, 24), channel(b.col, 24), channel(c.col, 24) }, area);
+        }
+    }
+
+    for (auto y = top; y < bottom; y += 1)
+    {
+        auto const centreY = static_cast<float>(y) + 0.5f;
+
+        // exactly two edges cross the row, each one counted from its upper end included to its lower end excluded
+        auto left = std::numeric_limits<float>::max();
+        auto right = std::numeric_limits<float>::lowest();
+
+        for (size_t edge = 0; edge < 3; edge += 1)
+        {
+            auto const& from = points[edge];
+            auto const& to = points[(edge + 1) % 3];
+            if ((from.y <= centreY) == (to.y <= centreY)) continue;
+
+            auto const x = from.x + (centreY - from.y) * (to.x - from.x) / (to.y - from.y);
+            left = std::min(left, x);
+            right = std::max(right, x);
+        }
+
+        auto const begin = std::max(canvas.left, static_cast<int>(std::ceil(left - 0.5f)));
+        auto const end = std::min(canvas.right, static_cast<int>(std::ceil(right - 0.5f)));
+        if (begin >= end) continue;
+
+        auto* row = canvas.pixels + static_cast<size_t>(y) * static_cast<size_t>(canvas.width);
+
+        if (flat)
+        {
+            blend_span(row + begin, end - begin, flatColour);
+            continue;
+        }
+
+        auto const centreX = static_cast<float>(begin) + 0.5f;
+        auto pixelU = u.at(centreX, centreY), pixelV = v.at(centreX, centreY);
+        auto pixelRed = red.at(centreX, centreY), pixelGreen = green.at(centreX, centreY), pixelBlue = blue.at(centreX, centreY), pixelAlpha = alpha.at(centreX, centreY);
+
+        for (auto x = begin; x < end; x += 1)
+        {
+            auto colour = a.col;
+
+            if (!sameColour)
+            {
+                auto const byte = [] (float value) { return static_cast<uint32_t>(std::clamp(value + 0.5f, 0.f, 255.f)); };
+                colour = byte(pixelRed) | byte(pixelGreen) << 8 | byte(pixelBlue) << 16 | byte(pixelAlpha) << 24;
+                pixelRed += red.dx; pixelGreen += green.dx; pixelBlue += blue.dx; pixelAlpha += alpha.dx;
+            }
+
+            row[x] = blend(row[x], modulate(texture.sample(pixelU, pixelV), colour));
+            pixelU += u.dx; pixelV += v.dx;
+        }
+    }
+}
+
+// the display belongs to glfw, only what is created on it here is released
+struct PresentTarget
+{
+    Display* display = nullptr;
+    Window window = None;
+    GC gc = nullptr;
+    Visual* visual = nullptr;
+    int depth = 0;
+
+    XImage* image = nullptr;
+    XShmSegmentInfo shm {};
+    bool usesShm = false;
+
+    void release_image()
+    {
+        if (image == nullptr) return;
+
+        if (usesShm)
+        {
+            XShmDetach(display, &shm);
+            XSync(display, False);
+            shmdt(shm.shmaddr);
+            image->data = nullptr;
+        }
+
+        XDestroyImage(image);
+        image = nullptr;
+        shm = {};
+    }
+
+    ~PresentTarget()
+    {
+        release_image();
+        if (gc) XFreeGC(display, gc);
+    }
+};
+
+static bool shmAttachFailed = false;
+
+// the server has to be able to attach to the segment, which one on another machine can't. that is only known
+// once it has been tried, after which plain images are used from then on.
+static bool create_shm_image(PresentTarget& target, int width, int height)
+{
+    auto& shm = target.shm;
+
+    target.image = XShmCreateImage(target.display, target.visual, static_cast<unsigned>(target.depth), ZPixmap, nullptr, &shm, static_cast<unsigned>(width), static_cast<unsigned>(height));
+    if (target.image == nullptr) return false;
+
+    shm.shmid = shmget(IPC_PRIVATE, static_cast<size_t>(target.image->bytes_per_line) * static_cast<size_t>(height), IPC_CREAT | 0600);
+    auto const address = shm.shmid == -1 ? reinterpret_cast<void*>(-1) : shmat(shm.shmid, nullptr, 0);
+
+    auto attached = false;
+
+    if (address != reinterpret_cast<void*>(-1))
+    {
+        shm.shmaddr = target.image->data = static_cast<char*>(address);
+        shm.readOnly = False;
+
+        shmAttachFailed = false;
+        auto const previousErrorHandler = XSetErrorHandler([] (Display*, XErrorEvent*) { shmAttachFailed = true; return 0; });
+        XShmAttach(target.display, &shm);
+        XSync(target.display, False);
+        XSetErrorHandler(previousErrorHandler);
+
+        attached = !shmAttachFailed;
+        if (!attached) shmdt(address);
+    }
+
+    // the segment goes away on its own once both sides have detached from it
+    if (shm.shmid != -1) shmctl(shm.shmid, IPC_RMID, nullptr);
+
+    if (!attached)
+    {
+        target.image->data = nullptr;
+        XDestroyImage(target.image);
+        target.image = nullptr;
+        shm = {};
+    }
+
+    return attached;
+}
+
+SoftwareRenderer::SoftwareRenderer() = default;
+
+liberror::Result<std::unique_ptr<SoftwareRenderer>> SoftwareRenderer::open(GLFWwindow* window)
+{
+    auto const display = glfwGetX11Display();
+    auto const xWindow = glfwGetX11Window(window);
+
+    XWindowAttributes attributes {};
+    if (display == nullptr || !XGetWindowAttributes(display, xWindow, &attributes))
+        return liberror::make_error("Failed to query the window to draw into");
+
+    // the frame is kept as 32 bit pixels and only the channels are swapped on the way out
+    if (attributes.visual->c_class != TrueColor || attributes.visual->red_mask != 0xFF0000 || attributes.visual->green_mask != 0xFF00 || attributes.visual->blue_mask != 0xFF)
+        return liberror::make_error("The software renderer needs a 24 or 32 bit true colour visual");
+
+    std::unique_ptr<SoftwareRenderer> renderer { new SoftwareRenderer() };
+    renderer->target = std::make_unique<PresentTarget>();
+    auto& target = *renderer->target;
+    target.display = display;
+    target.window = xWindow;
+    target.visual = attributes.visual;
+    target.depth = attributes.depth;
+    target.gc = XCreateGC(display, xWindow, 0, nullptr);
+    target.usesShm = XShmQueryExtension(display);
+
+    return renderer;
+}
+
+std::unique_ptr<SoftwareRenderer> SoftwareRenderer::open_offscreen()
+{
+    return std::unique_ptr<SoftwareRenderer> { new SoftwareRenderer() };
+}
+
+SoftwareRenderer::~SoftwareRenderer()
+{
+    set_memory_usage("software renderer", { 0, 0 });
+}
+
+liberror::Result<void> SoftwareRenderer::resize(int newWidth, int newHeight)
+{
+    width = newWidth;
+    height = newHeight;
+
+    auto const pixels = static_cast<size_t>(width) * static_cast<size_t>(height);
+    frame.assign(pixels, 0);
+    fullDamage = true;
+
+    size_t bytes = 0;
+    for (auto const& [id, texture] : textures) bytes += texture.pixels.capacity() * sizeof(uint32_t);
+
+    if (!target)
+    {
+        set_memory_usage("software renderer", { bytes + frame.capacity() * sizeof(uint32_t), 0 });
+        return {};
+    }
+
+    target->release_image();
+
+    if (target->usesShm && !create_shm_image(*target, width, height))
+    {
+        target->usesShm = false;
+    }
+
+    if (!target->usesShm)
+    {
+        auto const data = static_cast<char*>(std::malloc(static_cast<size_t>(width) * static_cast<size_t>(height) * 4));
+        target->image = XCreateImage(target->display, target->visual, static_cast<unsigned>(target->depth), ZPixmap, 0, data, static_cast<unsigned>(width), static_cast<unsigned>(height), 32, 0);
+
+        if (target->image == nullptr)
+        {
+            std::free(data);
+            return liberror::make_error("Failed to create an image of {}x{}", width, height);
+        }
+    }
+
+    if (target->image->bits_per_pixel != 32)
+        return liberror::make_error("The software renderer needs 32 bits per pixel, the server uses {}", target->image->bits_per_pixel);
+
+    previous.assign(pixels, 0);
+
+    bytes += (frame.capacity() + previous.capacity()) * sizeof(uint32_t) + static_cast<size_t>(target->image->bytes_per_line) * static_cast<size_t>(height);
+    set_memory_usage("software renderer", { bytes, 0 });
+
+    return {};
+}
+
+ImTextureID SoftwareRenderer::create_texture(int textureWidth, int textureHeight, uint32_t const* pixels)
+{
+    auto const id = nextTexture++;
+    auto const count = static_cast<size_t>(textureWidth) * static_cast<size_t>(textureHeight);
+    textures.emplace(id, Texture { textureWidth, textureHeight, std::vector<uint32_t>(pixels, pixels + count) });
+    return id;
+}
+
+void SoftwareRenderer::destroy_texture(ImTextureID texture)
+{
+    textures.erase(texture);
+}
+
+void SoftwareRenderer::draw_list(ImDrawList const& list, ImVec2 origin)
+{
+    for (auto const& command : list.CmdBuffer)
+    {
+        // the ui submits no draw callbacks of its own
+        if (command.UserCallback != nullptr) continue;
+
+        auto const texture = textures.find(command.GetTexID());
+        if (texture == textures.end()) continue;
+
+        Canvas const canvas {
+            .pixels = frame.data(),
+            .width = width,
+            .left = std::max(0, static_cast<int>(command.ClipRect.x - origin.x)),
+            .top = std::max(0, static_cast<int>(command.ClipRect.y - origin.y)),
+            .right = std::min(width, static_cast<int>(command.ClipRect.z - origin.x)),
+            .bottom = std::min(height, static_cast<int>(command.ClipRect.w - origin.y)),
+        };
+
+        if (canvas.left >= canvas.right || canvas.top >= canvas.bottom) continue;
+
+        Sampler const sampler { texture->second.width, texture->second.height, texture->second.pixels.data() };
+
+        auto const* indices = list.IdxBuffer.Data + command.IdxOffset;
+        auto const* vertices = list.VtxBuffer.Data + command.VtxOffset;
+
+        for (unsigned int i = 0; i + 2 < command.ElemCount; i += 3)
+        {
+            draw_triangle(canvas, sampler, vertices[indices[i]], vertices[indices[i + 1]], vertices[indices[i + 2]], origin);
+        }
+    }
+}
+
+void SoftwareRenderer::present()
+{
+    auto const tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    auto sent = false;
+
+    auto const changed = [&] (int left, int top, int right, int bottom) {
+        for (auto y = top; y < bottom; y += 1)
+        {
+            auto const offset = static_cast<size_t>(y) * static_cast<size_t>(width) + static_cast<size_t>(left);
+            if (std::memcmp(frame.data() + offset, previous.data() + offset, static_cast<size_t>(right - left) * sizeof(uint32_t)) != 0) return true;
+        }
+
+        return false;
+    };
+
+    auto const send = [&] (int left, int top, int right, int bottom) {
+        for (auto y = top; y < bottom; y += 1)
+        {
+            auto const offset = static_cast<size_t>(y) * static_cast<size_t>(width);
+            auto* destination = reinterpret_cast<uint32_t*>(target->image->data + static_cast<size_t>(y) * static_cast<size_t>(target->image->bytes_per_line));
+
+            for (auto x = left; x < right; x += 1)
+            {
+                auto const pixel = frame[offset + static_cast<size_t>(x)];
+                destination[x] = (pixel & 0xFF) << 16 | (pixel & 0xFF00) | (pixel >> 16 & 0xFF);
+            }
+
+            std::memcpy(previous.data() + offset + left, frame.data() + offset + left, static_cast<size_t>(right - left) * sizeof(uint32_t));
+        }
+
+        auto const w = static_cast<unsigned>(right - left), h = static_cast<unsigned>(bottom - top);
+
+        if (target->usesShm)
+            XShmPutImage(target->display, target->window, target->gc, target->image, left, top, left, top, w, h, False);
+        else
+            XPutImage(target->display, target->window, target->gc, target->image, left, top, left, top, w, h);
+
+        sent = true;
+    };
+
+    // dirty tiles next to each other in a row of tiles go out as one rectangle
+    for (auto top = 0; top < height; top += TILE_SIZE)
+    {
+        auto const bottom = std::min(height, top + TILE_SIZE);
+        auto runStart = -1;
+
+        for (auto tile = 0; tile <= tilesX; tile += 1)
+        {
+            auto const left = tile * TILE_SIZE;
+            auto const dirty = tile < tilesX && (fullDamage || changed(left, top, std::min(width, left + TILE_SIZE), bottom));
+
+            if (dirty && runStart == -1) runStart = left;
+
+            if (!dirty && runStart != -1)
+            {
+                send(runStart, top, std::min(width, left), bottom);
+                runStart = -1;
+            }
+        }
+    }
+
+    fullDamage = false;
+
+    if (!sent) return;
+
+    // the server reads a shared image whenever it gets to it, so it has to be done before the next frame is written
+    if (target->usesShm)
+        XSync(target->display, False);
+    else
+        XFlush(target->display);
+}
+
+liberror::Result<void> SoftwareRenderer::render(ImDrawData const& drawData)
+{
+    TRACE_SCOPE("software_render");
+
+    auto const frameWidth = static_cast<int>(drawData.DisplaySize.x * drawData.FramebufferScale.x);
+    auto const frameHeight = static_cast<int>(drawData.DisplaySize.y * drawData.FramebufferScale.y);
+    if (frameWidth <= 0 || frameHeight <= 0) return {};
+
+    if (frameWidth != width || frameHeight != height) TRY(resize(frameWidth, frameHeight));
+
+    std::fill(frame.begin(), frame.end(), 0xFF000000);
+
+    for (auto const* list : drawData.CmdLists)
+    {
+        draw_list(*list, drawData.DisplayPos);
+    }
+
+    if (target) present();
+
+    return {};
+}
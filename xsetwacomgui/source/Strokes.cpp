@@ -0,0 +1,128 @@
+#include "Strokes.hpp"
+
+#include "Binary.hpp"
+
+#include <fmt/format.h>
+#include <fmt/std.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+static constexpr char STROKE_MAGIC[8] { 'X', 'W', 'G', 'S', 'T', 'R', 'K', '1' };
+
+static uint16_t quantise(float value)
+{
+    return static_cast<uint16_t>(std::lround(std::clamp(value, 0.f, 1.f) * 65535.f));
+}
+
+static float dequantise(uint16_t value)
+{
+    return static_cast<float>(value) / 65535.f;
+}
+
+void Stroke::push(float sampleTime, float sampleX, float sampleY, float samplePressure)
+{
+    time.push_back(sampleTime);
+    x.push_back(sampleX);
+    y.push_back(sampleY);
+    pressure.push_back(samplePressure);
+}
+
+liberror::Result<void> save_stroke(std::filesystem::path const& path, Stroke const& stroke)
+{
+    BinaryWriter writer {};
+    writer.buffer.reserve(sizeof(STROKE_MAGIC) + sizeof(uint32_t) + stroke.size() * 10);
+
+    writer.write(STROKE_MAGIC);
+    writer.write(static_cast<uint32_t>(stroke.size()));
+
+    for (size_t i = 0; i < stroke.size(); i += 1)
+    {
+        writer.write(static_cast<uint32_t>(std::lround(static_cast<double>(stroke.time[i]) * 1e6)));
+        writer.write(quantise(stroke.x[i]));
+        writer.write(quantise(stroke.y[i]));
+        writer.write(quantise(stroke.pressure[i]));
+    }
+
+    std::error_code error {};
+    std::filesystem::create_directories(path.parent_path(), error);
+
+    std::ofstream stream(path, std::ios::binary);
+    stream.write(writer.buffer.data(), static_cast<std::streamsize>(writer.buffer.size()));
+
+    if (stream.bad() || stream.fail())
+        return liberror::make_error("Failed to write the stroke to {}", path.string());
+
+    return {};
+}
+
+liberror::Result<Stroke> load_stroke(std::filesystem::path const& path)
+{
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream.is_open())
+        return liberror::make_error("Failed to open the stroke {}", path.string());
+
+    std::stringstream content;
+    content << stream.rdbuf();
+    auto const data = content.str();
+
+    BinaryReader reader { data };
+
+    char magic[sizeof(STROKE_MAGIC)] {};
+    reader.read(magic);
+    if (reader.failed() || std::memcmp(magic, STROKE_MAGIC, sizeof(magic)) != 0)
+        return liberror::make_error("{} is not a stroke recorded by this version of " NAME, path.string());
+
+    uint32_t count = 0;
+    reader.read(count);
+
+    // a truncated file is caught before reserving for a count that was never written
+    if (reader.failed() || data.size() < sizeof(STROKE_MAGIC) + sizeof(count) + static_cast<size_t>(count) * 10)
+        return liberror::make_error("The stroke {} is truncated", path.string());
+
+    Stroke stroke {};
+    stroke.time.reserve(count);
+    stroke.x.reserve(count);
+    stroke.y.reserve(count);
+    stroke.pressure.reserve(count);
+
+    for (uint32_t i = 0; i < count; i += 1)
+    {
+        uint32_t time = 0;
+        uint16_t x = 0, y = 0, pressure = 0;
+        reader.read(time);
+        reader.read(x);
+        reader.read(y);
+        reader.read(pressure);
+
+        stroke.push(static_cast<float>(time) / 1e6f, dequantise(x), dequantise(y), dequantise(pressure));
+    }
+
+    return stroke;
+}
+
+std::vector<std::filesystem::path> get_saved_strokes()
+{
+    std::vector<std::filesystem::path> strokes {};
+
+    std::error_code error {};
+    for (auto const& entry : std::filesystem::directory_iterator(STROKES_PATH, error))
+    {
+        if (entry.path().extension() == ".bin") strokes.push_back(entry.path());
+    }
+
+    std::ranges::sort(strokes);
+    return strokes;
+}
+
+std::filesystem::path make_stroke_path()
+{
+    for (size_t index = 1;; index += 1)
+    {
+        auto path = STROKES_PATH / fmt::format("stroke-{}.bin", index);
+        if (!std::filesystem::exists(path)) return path;
+    }
+}
@@ -0,0 +1,148 @@
+#include "Theme.hpp"
+
+#include "Resources.hpp"
+#include "Trace.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <filesystem>
+#include <map>
+#include <optional>
+
+struct Theme
+{
+    std::string base;
+    std::map<int, ImVec4> colors;
+    std::map<std::string, ImVec4> palette;
+};
+
+static ThemePalette& the_mutable_theme_palette()
+{
+    static ThemePalette palette {};
+    return palette;
+}
+
+ThemePalette const& the_theme_palette()
+{
+    return the_mutable_theme_palette();
+}
+
+// colours are written as "#rrggbb" or "#rrggbbaa"
+static std::optional<ImVec4> parse_color(std::string_view value)
+{
+    if (!value.starts_with('#') || (value.size() != 7 && value.size() != 9)) return std::nullopt;
+
+    unsigned rgba = 0;
+    if (std::from_chars(value.data() + 1, value.data() + value.size(), rgba, 16).ec != std::errc {}) return std::nullopt;
+    if (value.size() == 7) rgba = (rgba << 8) | 0xff;
+
+    auto const channel = [rgba] (int shift) { return static_cast<float>((rgba >> shift) & 0xff) / 255.f; };
+    return ImVec4 { channel(24), channel(16), channel(8), channel(0) };
+}
+
+static std::optional<Theme> load_theme(std::string const& resource)
+{
+    auto const content = get_resource(resource);
+    if (!content.has_value()) return std::nullopt;
+
+    try
+    {
+        auto json = nlohmann::json::parse(content->begin(), content->end());
+
+        Theme theme { .base = json.value("base", "DARK"), .colors = {}, .palette = {} };
+
+        if (json.contains("colors"))
+        {
+            for (int color = 0; color < ImGuiCol_COUNT; color += 1)
+            {
+                auto const name = ImGui::GetStyleColorName(color);
+                if (!json["colors"].contains(name)) continue;
+                if (auto value = parse_color(json["colors"][name].get<std::string>())) theme.colors[color] = *value;
+            }
+        }
+
+        if (json.contains("palette"))
+        {
+            for (auto const& [name, value] : json["palette"].items())
+            {
+                if (auto color = parse_color(value.get<std::string>())) theme.palette[name] = *color;
+            }
+        }
+
+        return theme;
+    }
+    catch (std::exception const&)
+    {
+        return std::nullopt;
+    }
+}
+
+static std::map<std::string, std::string> const& get_theme_files()
+{
+    static auto const files = [] {
+        std::map<std::string, std::string> result {};
+
+        for (auto const& resource : list_resources("themes"))
+        {
+            std::filesystem::path const path { resource };
+            if (path.extension() != ".json") continue;
+
+            auto name = path.stem().string();
+            std::ranges::transform(name, name.begin(), [] (unsigned char c) { return static_cast<char>(std::toupper(c)); });
+            if (name != "DARK" && name != "LIGHT") result[name] = resource;
+        }
+
+        return result;
+    }();
+
+    return files;
+}
+
+std::vector<std::string> const& get_available_themes()
+{
+    static auto const themes = [] {
+        std::vector<std::string> result { "DARK", "LIGHT" };
+        for (auto const& [name, path] : get_theme_files()) result.push_back(name);
+        return result;
+    }();
+
+    return themes;
+}
+
+void apply_theme(std::string_view name)
+{
+    TraceSpan span { "apply_theme" };
+    span.argument("theme", std::string(name));
+
+    Theme theme { .base = std::string(name), .colors = {}, .palette = {} };
+
+    if (auto file = get_theme_files().find(std::string(name)); file != get_theme_files().end())
+    {
+        if (auto loaded = load_theme(file->second)) theme = std::move(*loaded);
+        else theme.base = "DARK";
+    }
+
+    auto& style = ImGui::GetStyle();
+
+    if (theme.base == "LIGHT") ImGui::StyleColorsLight(&style);
+    else ImGui::StyleColorsDark(&style);
+
+    for (auto const& [color, value] : theme.colors) style.Colors[color] = value;
+
+    // the widgets follow the style unless the palette says otherwise
+    auto const pack = [&] (char const* key, int fallback) {
+        auto const color = theme.palette.find(key);
+        return ImGui::ColorConvertFloat4ToU32(color != theme.palette.end() ? color->second : style.Colors[fallback]);
+    };
+
+    the_mutable_theme_palette() = {
+        .mapperBackground = pack("mapperBackground", ImGuiCol_FrameBg),
+        .mapperBackgroundContrast = pack("mapperBackgroundContrast", ImGuiCol_MenuBarBg),
+        .mapperGrid = pack("mapperGrid", ImGuiCol_FrameBgHovered),
+        .mapperGrab = pack("mapperGrab", ImGuiCol_SliderGrab),
+        .mapperGrabActive = pack("mapperGrabActive", ImGuiCol_SliderGrabActive),
+    };
+}
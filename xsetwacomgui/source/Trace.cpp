@@ -0,0 +1,136 @@
+#include "Trace.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <unistd.h>
+
+struct TraceEvent
+{
+    char const* name;
+    std::chrono::steady_clock::time_point begin;
+    std::chrono::steady_clock::duration duration;
+    std::vector<std::pair<char const*, std::string>> arguments;
+};
+
+struct TraceBuffer
+{
+    size_t thread;
+    // only ever contended while the trace is being written out
+    std::mutex mutex;
+    std::vector<TraceEvent> events;
+};
+
+struct Tracer
+{
+    std::atomic<bool> active = false;
+    std::filesystem::path path;
+    std::chrono::steady_clock::time_point start;
+
+    std::mutex mutex;
+    std::vector<std::shared_ptr<TraceBuffer>> buffers;
+};
+
+static Tracer& the_tracer()
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+static TraceBuffer& the_thread_buffer()
+{
+    // the buffer is shared with the tracer so that it survives the thread that filled it
+    thread_local std::shared_ptr<TraceBuffer> buffer = [] {
+        auto& tracer = the_tracer();
+        std::scoped_lock lock(tracer.mutex);
+        auto created = std::make_shared<TraceBuffer>();
+        created->thread = tracer.buffers.size() + 1;
+        tracer.buffers.push_back(created);
+        return created;
+    }();
+
+    return *buffer;
+}
+
+void start_tracing(std::filesystem::path path)
+{
+    auto& tracer = the_tracer();
+    tracer.path = std::move(path);
+    tracer.start = std::chrono::steady_clock::now();
+    tracer.active.store(true, std::memory_order_release);
+}
+
+liberror::Result<void> stop_tracing()
+{
+    auto& tracer = the_tracer();
+    if (!tracer.active.exchange(false, std::memory_order_acq_rel)) return {};
+
+    auto const microseconds = [] (std::chrono::steady_clock::duration duration) {
+        return std::chrono::duration<double, std::micro>(duration).count();
+    };
+
+    auto events = nlohmann::json::array();
+
+    std::scoped_lock lock(tracer.mutex);
+    for (auto const& buffer : tracer.buffers)
+    {
+        std::scoped_lock bufferLock(buffer->mutex);
+        for (auto const& event : buffer->events)
+        {
+            auto arguments = nlohmann::json::object();
+            for (auto const& [key, value] : event.arguments) arguments[key] = value;
+
+            events.push_back({
+                { "name", event.name },
+                { "cat", NAME },
+                { "ph", "X" },
+                { "ts", microseconds(event.begin - tracer.start) },
+                { "dur", microseconds(event.duration) },
+                { "pid", getpid() },
+                { "tid", buffer->thread },
+                { "args", std::move(arguments) },
+            });
+        }
+    }
+
+    std::ofstream stream(tracer.path);
+    stream << nlohmann::json { { "traceEvents", std::move(events) }, { "displayTimeUnit", "ms" } };
+
+    if (stream.bad() || stream.fail())
+    {
+        return liberror::make_error("Failed to write the trace to {}", tracer.path.string());
+    }
+
+    return {};
+}
+
+TraceSpan::TraceSpan(char const* spanName)
+    : name(spanName)
+    , active(the_tracer().active.load(std::memory_order_acquire))
+{
+    if (active) begin = std::chrono::steady_clock::now();
+}
+
+TraceSpan::~TraceSpan()
+{
+    end();
+}
+
+void TraceSpan::argument(char const* key, std::string value)
+{
+    if (active) arguments.emplace_back(key, std::move(value));
+}
+
+void TraceSpan::end()
+{
+    if (!active) return;
+    active = false;
+
+    auto const duration = std::chrono::steady_clock::now() - begin;
+    auto& buffer = the_thread_buffer();
+    std::scoped_lock lock(buffer.mutex);
+    buffer.events.push_back({ name, begin, duration, std::move(arguments) });
+}
@@ -1,13 +1,15 @@
 #define IMGUI_DEFINE_MATH_OPERATORS
 #include "Widgets.hpp"
 
+#include "Theme.hpp"
+
 static auto constexpr MAPPER_GRAB_RADIUS = 6;
 
-#define MAPPER_BACKGROUD_COLOR          ImColor(ImGui::GetStyle().Colors[ImGuiCol_FrameBg])
-#define MAPPER_BACKGROUD_CONTRAST_COLOR ImColor(ImGui::GetStyle().Colors[ImGuiCol_MenuBarBg])
-#define MAPPER_GRID_COLOR               ImColor(ImGui::GetStyle().Colors[ImGuiCol_FrameBgHovered])
-#define MAPPER_GRAB_COLOR               ImColor(ImGui::GetStyle().Colors[ImGuiCol_SliderGrab])
-#define MAPPER_GRAB_ACTIVE_COLOR        ImColor(ImGui::GetStyle().Colors[ImGuiCol_SliderGrabActive])
+#define MAPPER_BACKGROUD_COLOR          the_theme_palette().mapperBackground
+#define MAPPER_BACKGROUD_CONTRAST_COLOR the_theme_palette().mapperBackgroundContrast
+#define MAPPER_GRID_COLOR               the_theme_palette().mapperGrid
+#define MAPPER_GRAB_COLOR               the_theme_palette().mapperGrab
+#define MAPPER_GRAB_ACTIVE_COLOR        the_theme_palette().mapperGrabActive
 
 static bool area_mapper_render_grabbers(ImDrawList* const drawList, ImRect frame, ImVec2 size, ImVec2 anchors[4], char const* label, bool fullArea = false, bool = false)
 {
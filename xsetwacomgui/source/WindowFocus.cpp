@@ -0,0 +1,143 @@
+#include "WindowFocus.hpp"
+
+#include <X11/Xatom.h>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <optional>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+static Window get_active_window(Display* display, Window root, Atom activeWindow)
+{
+    Atom type = None;
+    int format = 0;
+    unsigned long count = 0, remaining = 0;
+    unsigned char* data = nullptr;
+
+    if (XGetWindowProperty(display, root, activeWindow, 0, 1, False, XA_WINDOW, &type, &format, &count, &remaining, &data) != Success)
+        return None;
+
+    // format 32 properties come back as longs whatever their size on the wire
+    Window window = None;
+    if (type == XA_WINDOW && format == 32 && count == 1) window = *reinterpret_cast<Window const*>(data);
+    if (data) XFree(data);
+
+    return window;
+}
+
+static WindowClass get_window_class(Display* display, Window window)
+{
+    XClassHint hint {};
+    if (window == None || !XGetClassHint(display, window, &hint)) return {};
+
+    WindowClass windowClass {
+        .instance = hint.res_name ? hint.res_name : "",
+        .name = hint.res_class ? hint.res_class : "",
+    };
+
+    if (hint.res_name) XFree(hint.res_name);
+    if (hint.res_class) XFree(hint.res_class);
+
+    return windowClass;
+}
+
+struct FocusConnection
+{
+    Display* display = nullptr;
+    int wake = -1;
+    XErrorHandler previousErrorHandler = nullptr;
+
+    ~FocusConnection()
+    {
+        if (wake != -1) close(wake);
+        if (display) XCloseDisplay(display);
+        XSetErrorHandler(previousErrorHandler);
+    }
+};
+
+liberror::Result<void> watch_window_focus(std::stop_token const& token, std::function<void(WindowClass const&)> const& handler)
+{
+    FocusConnection connection {};
+
+    // the focused window may be gone by the time it is asked about, which is not worth dying over
+    connection.previousErrorHandler = XSetErrorHandler([] (Display*, XErrorEvent*) { return 0; });
+
+    connection.display = XOpenDisplay(nullptr);
+    if (connection.display == nullptr)
+        return liberror::make_error("Failed to open the X display");
+
+    connection.wake = eventfd(0, EFD_CLOEXEC);
+    if (connection.wake == -1)
+        return liberror::make_error("Failed to create an eventfd");
+
+    auto const display = connection.display;
+    auto const wake = connection.wake;
+
+    std::stop_callback wakeUp { token, [wake] {
+        uint64_t const one = 1;
+        [[maybe_unused]] auto const written = write(wake, &one, sizeof(one));
+    }};
+
+    auto const root = DefaultRootWindow(display);
+    auto const activeWindow = XInternAtom(display, "_NET_ACTIVE_WINDOW", False);
+
+    XSelectInput(display, root, PropertyChangeMask);
+
+    Window focused = None;
+    std::optional<WindowClass> reported {};
+
+    auto const update = [&] {
+        auto const window = get_active_window(display, root, activeWindow);
+
+        // some programs only set their class after being mapped, so the focused window is watched as well
+        if (window != focused)
+        {
+            if (focused != None) XSelectInput(display, focused, NoEventMask);
+            if (window != None) XSelectInput(display, window, PropertyChangeMask);
+            focused = window;
+        }
+
+        auto windowClass = get_window_class(display, focused);
+        if (reported == windowClass) return;
+
+        reported = std::move(windowClass);
+        handler(*reported);
+    };
+
+    update();
+
+    while (!token.stop_requested())
+    {
+        XFlush(display);
+
+        std::array<pollfd, 2> descriptors {{
+            { ConnectionNumber(display), POLLIN, 0 },
+            { wake, POLLIN, 0 },
+        }};
+
+        if (XPending(display) == 0 && poll(descriptors.data(), descriptors.size(), -1) < 0 && errno != EINTR)
+            return liberror::make_error("Failed to wait on the X connection");
+
+        auto changed = false;
+
+        while (XPending(display) > 0)
+        {
+            XEvent event;
+            XNextEvent(display, &event);
+
+            if (event.type != PropertyNotify) continue;
+
+            auto const& property = event.xproperty;
+            changed |= (property.window == root && property.atom == activeWindow) || (property.window == focused && property.atom == XA_WM_CLASS);
+        }
+
+        if (changed) update();
+    }
+
+    return {};
+}
@@ -0,0 +1,151 @@
+#include "Process.hpp"
+
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+#include <X11/Xlib.h>
+#include <X11/extensions/XTest.h>
+
+#include <spawn.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <thread>
+
+// runs --measure-input against the XTest pointer of a private Xvfb while the pointer is moved through
+// XTest, so the whole of the capture is exercised without a tablet
+static constexpr char const* DEVICE = "Virtual core XTEST pointer";
+static constexpr int SECONDS = 2;
+
+struct Server
+{
+    pid_t pid = -1;
+
+    ~Server()
+    {
+        if (pid <= 0) return;
+
+        kill(pid, SIGTERM);
+        waitpid(pid, nullptr, 0);
+    }
+};
+
+// the server picks a free display and writes its number to the descriptor it is given once it is ready
+static std::optional<std::string> start_server(Server& server, char const* executable)
+{
+    std::array<int, 2> fds {};
+    if (pipe(fds.data()) != 0) return std::nullopt;
+
+    auto const displayFd = std::to_string(fds[1]);
+    std::array<char const*, 6> argv { executable, "-displayfd", displayFd.c_str(), "-nolisten", "tcp", nullptr };
+
+    auto const spawned = posix_spawn(&server.pid, executable, nullptr, nullptr, const_cast<char* const*>(argv.data()), environ);
+    close(fds[1]);
+
+    if (spawned != 0)
+    {
+        close(fds[0]);
+        return std::nullopt;
+    }
+
+    std::string display {};
+    char character = 0;
+    while (read(fds[0], &character, 1) == 1 && character != '\n') display += character;
+    close(fds[0]);
+
+    if (display.empty()) return std::nullopt;
+
+    return ":" + display;
+}
+
+int main(int argc, char const** argv)
+{
+    if (argc != 3)
+    {
+        fmt::println("usage: MeasureInputTest XSETWACOMGUI XVFB");
+        return EXIT_FAILURE;
+    }
+
+    Server server {};
+    auto const display = start_server(server, argv[2]);
+    if (!display.has_value())
+    {
+        fmt::println("FAILED to start {}", argv[2]);
+        return EXIT_FAILURE;
+    }
+
+    setenv("DISPLAY", display->c_str(), 1);
+
+    auto connection = XOpenDisplay(nullptr);
+    if (connection == nullptr)
+    {
+        fmt::println("FAILED to open {}", *display);
+        return EXIT_FAILURE;
+    }
+
+    // keeps moving the pointer for longer than the capture runs, starting before it does
+    std::atomic<bool> moving = true;
+    std::thread mover([&] {
+        for (int step = 0; moving.load(); step += 1)
+        {
+            XTestFakeMotionEvent(connection, 0, 100 + step % 400, 100 + step % 300, 0);
+            XFlush(connection);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    });
+
+    auto const result = run_process({ argv[1], fmt::format("--measure-input={}", SECONDS), fmt::format("--measure-device={}", DEVICE) }, { .timeout = std::chrono::seconds(SECONDS + 10) });
+
+    moving.store(false);
+    mover.join();
+    XCloseDisplay(connection);
+
+    if (!result.has_value())
+    {
+        fmt::println("FAILED {}", result.error().message());
+        return EXIT_FAILURE;
+    }
+
+    if (result->exitStatus != 0)
+    {
+        fmt::println("FAILED --measure-input exited with {}: {}", result->exitStatus, result->error);
+        return EXIT_FAILURE;
+    }
+
+    size_t failures = 0;
+
+    auto const check = [&] (bool passed, std::string const& what) {
+        if (!passed)
+        {
+            fmt::println("FAILED {}", what);
+            failures += 1;
+        }
+    };
+
+    try
+    {
+        auto const report = nlohmann::json::parse(result->output);
+
+        check(report["device"] == DEVICE, "the report is for another device");
+        check(report["raw"]["events"].get<size_t>() > 0, "no raw events were captured");
+        check(report["raw"]["outOfOrder"].get<size_t>() == 0, "the server times of the raw events go backwards");
+        check(report["cooked"]["events"].get<size_t>() > 0, "no cooked events were captured");
+        check(!report["latencyUs"]["raw"].is_null(), "no latency was measured");
+
+        fmt::println("{} raw and {} cooked events", report["raw"]["events"].get<size_t>(), report["cooked"]["events"].get<size_t>());
+    }
+    catch (std::exception const& error)
+    {
+        fmt::println("FAILED the report could not be read: {}\n{}", error.what(), result->output);
+        return EXIT_FAILURE;
+    }
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,96 @@
+#include "PressureFit.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+
+// a fit is only as good as the strokes it is given, so the synthetic ones are checked against the hands that drew them
+struct Case
+{
+    char const* name;
+    libwacom::Pressure hand;
+    double maxControlError;
+};
+
+// three targets pin a curve down but not its four controls: a hand that bends one way much more than the
+// other is matched just as closely by controls that sit elsewhere, so those are only held loosely
+static constexpr std::array CASES {
+    Case { "linear", { 0.f, 0.f, 1.f, 1.f }, 0.03 },
+    Case { "soft", { 0.1f, 0.4f, 0.5f, 0.95f }, 0.25 },
+    Case { "firm", { 0.5f, 0.05f, 0.9f, 0.6f }, 0.25 },
+    Case { "s-shaped", { 0.3f, 0.f, 0.7f, 1.f }, 0.03 },
+};
+
+static constexpr uint32_t SEEDS = 4;
+
+static constexpr double MAX_RESIDUAL = 0.06;      // root mean square, the strokes alone wobble by 0.03
+static constexpr double MAX_TARGET_ERROR = 0.04;  // at the raw pressure the hand uses for each target
+static constexpr double MAX_CURVE_ERROR = 0.08;   // between the two curves, anywhere in [0, 1]
+
+// the raw pressure at which the curve gives the output, the curve only ever goes up
+static double invert(libwacom::Pressure const& curve, double output)
+{
+    double low = 0, high = 1;
+
+    for (int step = 0; step < 40; step += 1)
+    {
+        auto const middle = (low + high) / 2;
+        (evaluate_pressure_bezier(curve, middle) < output ? low : high) = middle;
+    }
+
+    return (low + high) / 2;
+}
+
+int main()
+{
+    size_t failures = 0;
+
+    auto const check = [&] (bool passed, std::string const& what) {
+        if (!passed)
+        {
+            fmt::println("FAILED {}", what);
+            failures += 1;
+        }
+    };
+
+    for (auto const& [name, hand, maxControlError] : CASES)
+    {
+        for (uint32_t seed = 0; seed < SEEDS; seed += 1)
+        {
+            auto const calibration = make_synthetic_calibration(hand, seed);
+            auto const fit = fit_pressure_curve(calibration, { 0, 0, 1, 1 });
+            auto const label = fmt::format("{} (seed {})", name, seed);
+
+            check(fit.has_value(), fmt::format("{}: {}", label, fit.has_value() ? "" : fit.error().message()));
+            if (!fit.has_value()) continue;
+
+            check(fit->error <= MAX_RESIDUAL, fmt::format("{}: residual {:.4f} over {}", label, fit->error, MAX_RESIDUAL));
+
+            for (double const target : CALIBRATION_TARGETS)
+            {
+                auto const output = evaluate_pressure_bezier(fit->curve, invert(hand, target));
+                check(std::abs(output - target) <= MAX_TARGET_ERROR, fmt::format("{}: gives {:.3f} instead of {}", label, output, target));
+            }
+
+            auto const& curve = fit->curve;
+            double const controlError = std::max({ std::abs(curve.minX - hand.minX), std::abs(curve.minY - hand.minY), std::abs(curve.maxX - hand.maxX), std::abs(curve.maxY - hand.maxY) });
+            check(controlError <= maxControlError, fmt::format("{}: a control is {:.4f} away from the hand's", label, controlError));
+
+            double curveError = 0;
+            for (int sample = 0; sample <= 100; sample += 1)
+            {
+                auto const pressure = sample / 100.0;
+                curveError = std::max(curveError, std::abs(evaluate_pressure_bezier(fit->curve, pressure) - evaluate_pressure_bezier(hand, pressure)));
+            }
+
+            check(curveError <= MAX_CURVE_ERROR, fmt::format("{}: strays {:.4f} from the curve of the hand", label, curveError));
+
+            fmt::println("{:<20} residual {:.4f}  control error {:.4f}  curve error {:.4f}  {} iterations", label, fit->error, controlError, curveError, fit->iterations);
+        }
+    }
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}